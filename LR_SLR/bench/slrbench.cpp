@@ -0,0 +1,553 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 19:40:16
+ * @LastEditTime: 2026-10-19 23:59:33
+ * @FilePath: /LR_SLR/bench/slrbench.cpp
+ * @Description: 语法分析吞吐基准测试：按文法随机生成指定大小的 LEX 记号流，统计解析速度、峰值内存和语法树大小，输出 JSON
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#include "grammer.h"
+#include "toolutil.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef LR_SLR_TEST_DIR
+#define LR_SLR_TEST_DIR "test"
+#endif
+
+using namespace std;
+
+static void usage() {
+    cerr <<
+        "Usage: slrbench [-g <grammar.txt>]... [-n <size,size,...>] [-s <seed>] [-m slr|lalr|lr1] [-G] [-t] [-w <dir>] [-o <result.json>]\n"
+        "  -g <file>    grammar to benchmark (default: minic.txt and tiny-bnf.txt in the LR_SLR test dir)\n"
+        "  -n <sizes>   comma separated .lex sizes in bytes, K/M/G suffixes allowed (default: 1K,16K,256K,4M,64M;\n"
+        "               1G works too but keeps a syntax tree of several GB in memory)\n"
+        "  -s <seed>    seed of the random sentence generator (default 2024)\n"
+        "  -m <mode>    parse table used by the parse cases (default slr)\n"
+        "  -G           parse with GLR instead of the deterministic LR parser\n"
+        "  -t           record the parse trace while parsing (off by default, ignored with -G)\n"
+        "  -w <dir>     also write every generated stream to <dir>/<grammar>-<size>.lex\n"
+        "  -o <file>    write the JSON result to <file> instead of stdout\n"
+        "Every case runs in its own process so that the peak RSS belongs to that case alone.\n"
+        "\"tables\" compares the states, build time and conflicts of the SLR(1), LALR(1)\n"
+        "and LR(1) tables of every grammar.\n";
+}
+
+// 当前进程的峰值内存（KB），未知为-1
+static long selfPeakRss() {
+#ifdef _WIN32
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // macOS 上单位为字节
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// 峰值内存的 JSON 值，未知为 null
+static string rssJson(long kb) {
+    return kb < 0 ? "null" : to_string(kb);
+}
+
+static string lowerCase(string str) {
+    for (auto& c : str) c = tolower((unsigned char)c);
+    return str;
+}
+
+/**
+ * 随机句子生成器：从起始符号开始最左推导，输出 LEX 文件（每行 LABEL : VALUE）
+ * 剩余预算充足时随机选择产生式（偏向递归产生式），预算用完后只选最短推导，使输出接近目标大小
+ * 符号编码：非终结符号为其编号，终结符号 t 为 -(t + 1)
+ */
+class SentenceGenerator {
+private:
+    Grammer& grammer;
+    vector<int> keys; // 产生式左部
+    vector<vector<int> > raws; // 产生式右部（已去掉 EPSILON）
+    vector<vector<int> > productionsOf; // 非终结符号 -> 产生式
+    vector<size_t> minCost; // 非终结符号的最短推导字节数
+    vector<int> minProduction; // 非终结符号的最短推导所用产生式
+    vector<size_t> productionCost; // 产生式右部的最短推导字节数
+    vector<bool> recursive; // 产生式右部能否推导回左部
+    vector<vector<bool> > reach; // 非终结符号之间的可达关系
+    vector<string> values; // 终结符号 -> VALUE，空则按 IDENTIFIER、NUMBER 生成
+    vector<int> valueKinds; // 0 固定值，1 标识符，2 数字
+    unsigned seed;
+    size_t counter = 0;
+
+    unsigned nextRandom() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) & 0x7fff;
+    }
+
+    // 终结符号一行的估计字节数
+    size_t terminalCost(int terminal) const {
+        const string& label = grammer.terminalName(terminal);
+        size_t value = valueKinds[terminal] == 0 ? values[terminal].size() : 4;
+        return label.size() + 3 + value + 1;
+    }
+
+    size_t symbolCost(int symbol) const {
+        return symbol >= 0 ? minCost[symbol] : terminalCost(-symbol - 1);
+    }
+
+    void appendTerminal(string& out, int terminal) {
+        out += grammer.terminalName(terminal);
+        out += " : ";
+        switch (valueKinds[terminal]) {
+        case 1:
+            out += "v" + to_string(counter++ % 997);
+            break;
+        case 2:
+            out += to_string(nextRandom() % 1000);
+            break;
+        default:
+            out += values[terminal];
+        }
+        out += '\n';
+    }
+
+public:
+    SentenceGenerator(Grammer& grammer, unsigned seed) : grammer(grammer), seed(seed) {
+        const SlrTable& table = grammer.getTable();
+        int nonterminals = table.nonterminalCount;
+        productionsOf.resize(nonterminals);
+        for (int terminal = 0; terminal < grammer.terminalCount(); ++terminal) {
+            string name = lowerCase(grammer.terminalName(terminal));
+            values.push_back(grammer.terminalName(terminal));
+            valueKinds.push_back(name == "identifier" ? 1 : name == "number" ? 2 : 0);
+        }
+        for (int p = 0; p < table.productionCount; ++p) {
+            keys.push_back(grammer.nonterminalId(grammer.productionKey(p)));
+            vector<int> raw;
+            for (const string& token : grammer.productionRaws(p)) {
+                if (token == EPSILON) continue;
+                int id = grammer.nonterminalId(token);
+                raw.push_back(id >= 0 ? id : -grammer.terminalId(token) - 1);
+            }
+            raws.push_back(raw);
+            productionsOf[keys.back()].push_back(p);
+        }
+
+        // 最短推导：代价相同时取推导高度更小的，保证只选最短推导时一定终止
+        minCost.assign(nonterminals, SIZE_MAX);
+        minProduction.assign(nonterminals, -1);
+        vector<int> height(nonterminals, INT_MAX);
+        productionCost.assign(raws.size(), SIZE_MAX);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int p = 0; p < (int)raws.size(); ++p) {
+                size_t cost = 0;
+                int depth = 0;
+                bool finite = true;
+                for (int symbol : raws[p]) {
+                    if (symbol >= 0 && minCost[symbol] == SIZE_MAX) {
+                        finite = false;
+                        break;
+                    }
+                    cost += symbolCost(symbol);
+                    if (symbol >= 0) depth = max(depth, height[symbol]);
+                }
+                if (!finite) continue;
+                productionCost[p] = cost;
+                int key = keys[p];
+                if (cost < minCost[key] || (cost == minCost[key] && depth + 1 < height[key])) {
+                    minCost[key] = cost;
+                    height[key] = depth + 1;
+                    minProduction[key] = p;
+                    changed = true;
+                }
+            }
+        }
+
+        // 可达关系，判断递归产生式
+        reach.assign(nonterminals, vector<bool>(nonterminals, false));
+        for (int p = 0; p < (int)raws.size(); ++p) {
+            for (int symbol : raws[p]) {
+                if (symbol >= 0) reach[keys[p]][symbol] = true;
+            }
+        }
+        for (int k = 0; k < nonterminals; ++k) {
+            for (int i = 0; i < nonterminals; ++i) {
+                if (!reach[i][k]) continue;
+                for (int j = 0; j < nonterminals; ++j) {
+                    if (reach[k][j]) reach[i][j] = true;
+                }
+            }
+        }
+        recursive.assign(raws.size(), false);
+        for (int p = 0; p < (int)raws.size(); ++p) {
+            for (int symbol : raws[p]) {
+                if (symbol >= 0 && (symbol == keys[p] || reach[symbol][keys[p]])) recursive[p] = true;
+            }
+        }
+    }
+
+    // 生成约 target 字节的 LEX 文本，失败（起始符号无法推导出终结符号串）时返回false
+    bool generate(size_t target, string& out, size_t& tokens) {
+        int start = grammer.nonterminalId(grammer.getStart());
+        out.clear();
+        tokens = 0;
+        if (start < 0 || minCost[start] == SIZE_MAX) return false;
+        out.reserve(target + 1024);
+        // 栈中每个符号带有自己的字节预算，用不完的预算留给下一个出栈的符号
+        vector<pair<int, size_t> > stack(1, { start, max(target, minCost[start]) });
+        size_t carry = 0;
+        vector<int> candidates;
+        vector<size_t> weights;
+        while (stack.size()) {
+            int symbol = stack.back().first;
+            size_t budget = stack.back().second + carry;
+            stack.pop_back();
+            carry = 0;
+            if (symbol < 0) {
+                appendTerminal(out, -symbol - 1);
+                tokens++;
+                carry = budget - terminalCost(-symbol - 1);
+                continue;
+            }
+            int chosen = minProduction[symbol];
+            if (budget > minCost[symbol]) {
+                // 列表类文法一旦选择非递归产生式就不再增长，预算充足时大概率继续递归
+                candidates.clear();
+                bool preferRecursive = nextRandom() % 8 != 0;
+                for (int pass = 0; pass < 2 && candidates.empty(); ++pass) {
+                    for (int p : productionsOf[symbol]) {
+                        if (productionCost[p] > budget) continue;
+                        if (pass == 0 && preferRecursive && !recursive[p]) continue;
+                        candidates.push_back(p);
+                    }
+                }
+                if (candidates.size()) chosen = candidates[nextRandom() % candidates.size()];
+            }
+            // 多出的预算随机分给右部的非终结符号，能推导回左部的符号（列表的剩余部分）分得更多
+            const vector<int>& raw = raws[chosen];
+            size_t extra = budget - productionCost[chosen], total = 0;
+            weights.assign(raw.size(), 0);
+            for (size_t i = 0; i < raw.size(); ++i) {
+                if (raw[i] < 0) continue;
+                weights[i] = 1 + nextRandom() % 16;
+                if (raw[i] == symbol || reach[raw[i]][symbol]) weights[i] *= 4;
+                total += weights[i];
+            }
+            size_t given = 0;
+            for (size_t i = raw.size(); i-- > 0;) {
+                size_t share = total ? (size_t)((double)extra * weights[i] / total) : 0;
+                given += share;
+                stack.push_back({ raw[i], symbolCost(raw[i]) + share });
+            }
+            carry = extra - min(extra, given);
+        }
+        return true;
+    }
+};
+
+// 统计语法树节点数（语义动作可能让节点被引用多次，需去重）
+static size_t treeSize(TreeNode* root) {
+    set<TreeNode*> visited;
+    vector<TreeNode*> prepared;
+    if (root) prepared.push_back(root);
+    while (prepared.size()) {
+        TreeNode* cur = prepared.back();
+        prepared.pop_back();
+        if (!visited.insert(cur).second) continue;
+        for (TreeNode* child : cur->children) {
+            if (child) prepared.push_back(child);
+        }
+    }
+    return visited.size();
+}
+
+// 解析 1K、16M 形式的大小
+static bool parseSizes(const string& text, vector<size_t>& sizes) {
+    stringstream ss(text);
+    string item;
+    sizes.clear();
+    while (getline(ss, item, ',')) {
+        char* end = nullptr;
+        unsigned long long size = strtoull(item.c_str(), &end, 10);
+        if (item.empty() || end == item.c_str()) return false;
+        switch (toupper((unsigned char)*end)) {
+        case 'G': size <<= 10; // fallthrough
+        case 'M': size <<= 10; // fallthrough
+        case 'K': size <<= 10; end++; break;
+        case 0: break;
+        default: return false;
+        }
+        if (*end) return false;
+        sizes.push_back(size);
+    }
+    return sizes.size() > 0;
+}
+
+// 各构造方法及其在 JSON 中的名称
+static const pair<SlrTableMode, const char*> MODES[] = {
+    { SLR_MODE_SLR, "slr" },
+    { SLR_MODE_LALR, "lalr" },
+    { SLR_MODE_LR1, "lr1" },
+};
+
+// 按三种构造方法分别生成分析表，返回 JSON 对象：状态数（LR(1) 与 SLR(1) 之比）、生成耗时和是否有冲突
+static string compareTables(const string& text) {
+    stringstream ss;
+    ss << '{';
+    size_t slrStates = 0;
+    for (auto& mode : MODES) {
+        auto begin = chrono::steady_clock::now();
+        Grammer grammer(text, "", nullptr, mode.first);
+        double buildTime = elapsed(begin);
+        if (mode.first != SLR_MODE_SLR) ss << ',';
+        ss << '"' << mode.second << "\":{";
+        if (grammer.bad()) {
+            ss << "\"error\":" << quote(grammer.getError()) << '}';
+            continue;
+        }
+        const SlrStats& stats = grammer.getStats();
+        if (mode.first == SLR_MODE_SLR) slrStates = stats.states;
+        ss << "\"states\":" << stats.states
+            << ",\"states_vs_slr\":" << (slrStates ? (double)stats.states / slrStates : 0)
+            << ",\"build_ms\":" << buildTime
+            << ",\"automaton_ms\":" << stats.automaton.ms
+            << ",\"lookahead_ms\":" << stats.lookahead.ms
+            << ",\"conflicts\":" << (grammer.slr() ? "false" : "true") << '}';
+    }
+    ss << '}';
+    return ss.str();
+}
+
+// 单个用例：构建文法 -> 生成输入 -> 解析，返回 JSON 字段（不含进程峰值内存）
+static string runCase(const string& text, SlrTableMode mode, size_t size, unsigned seed, bool glr, bool trace, const string& dump) {
+    stringstream ss;
+    auto begin = chrono::steady_clock::now();
+    Grammer grammer(text, "", nullptr, mode);
+    double buildTime = elapsed(begin);
+    long buildPeak = selfPeakRss();
+    if (grammer.bad()) {
+        ss << "\"error\":" << quote(grammer.getError());
+        return ss.str();
+    }
+    ss << "\"states\":" << grammer.getTable().stateCount
+        << ",\"build_ms\":" << buildTime
+        << ",\"build_peak_rss_kb\":" << rssJson(buildPeak);
+
+    string input;
+    size_t tokens = 0;
+    begin = chrono::steady_clock::now();
+    SentenceGenerator generator(grammer, seed);
+    if (!generator.generate(size, input, tokens)) {
+        ss << ",\"error\":" << quote("cannot derive a sentence from the start symbol");
+        return ss.str();
+    }
+    double generateTime = elapsed(begin);
+    if (dump.size()) {
+        ofstream os(dump, ios::out | ios::binary);
+        os.write(input.data(), input.size());
+    }
+    long inputPeak = selfPeakRss();
+
+    begin = chrono::steady_clock::now();
+    ParsedResult result = glr ? grammer.parseGlr(input) : grammer.parse(input, nullptr, trace);
+    double parseTime = elapsed(begin);
+    size_t nodes = treeSize(result.root);
+    double seconds = parseTime / 1000;
+    ss << ",\"input_bytes\":" << input.size()
+        << ",\"tokens\":" << tokens
+        << ",\"generate_ms\":" << generateTime
+        << ",\"input_peak_rss_kb\":" << rssJson(inputPeak)
+        << ",\"accept\":" << (result.accept && result.error.empty() ? "true" : "false")
+        << ",\"shifts\":" << result.shifts
+        << ",\"reductions\":" << result.reductions
+        << ",\"parse_ms\":" << parseTime
+        << ",\"tokens_per_s\":" << (seconds > 0 ? result.shifts / seconds : 0)
+        << ",\"reductions_per_s\":" << (seconds > 0 ? result.reductions / seconds : 0)
+        << ",\"tree_nodes\":" << nodes
+        << ",\"trace_entries\":" << result.trace.size()
+        << ",\"ambiguities\":" << result.ambiguities;
+    if (result.error.size()) ss << ",\"error\":" << quote(result.error);
+    freeTree(result.root);
+    // 分析表构建和解析各阶段的计数和内存分配
+    ss << ",\"stats\":" << grammer.getStats().toJson();
+    return ss.str();
+}
+
+// 在子进程中运行用例，返回 JSON 字段和峰值内存（KB，未知为-1）
+static bool runIsolated(const string& text, SlrTableMode mode, size_t size, unsigned seed, bool glr, bool trace, const string& dump, string& json, long& peak, string& error) {
+#ifdef _WIN32
+    // 没有 fork，只能在当前进程运行，峰值内存无法按用例区分
+    json = runCase(text, mode, size, seed, glr, trace, dump);
+    peak = -1;
+    return true;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        error = "pipe failed";
+        return false;
+    }
+    cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        error = "fork failed";
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        string out = runCase(text, mode, size, seed, glr, trace, dump);
+        size_t written = 0;
+        while (written < out.size()) {
+            ssize_t n = write(fds[1], out.data() + written, out.size() - written);
+            if (n <= 0) break;
+            written += n;
+        }
+        close(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    json.clear();
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) json.append(buf, n);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty()) {
+        error = "case crashed";
+        return false;
+    }
+#ifdef __APPLE__
+    peak = usage.ru_maxrss / 1024;
+#else
+    peak = usage.ru_maxrss;
+#endif
+    return true;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> grammers;
+    // 解析过程默认不记录，内存取决于语法树：tiny-bnf 每字节输入约 9 字节，1G 的用例要约 9G 内存，默认只到 64M
+    vector<size_t> sizes = { (size_t)1 << 10, (size_t)16 << 10, (size_t)256 << 10, (size_t)4 << 20, (size_t)64 << 20 };
+    unsigned seed = 2024;
+    SlrTableMode mode = SLR_MODE_SLR;
+    bool glr = false;
+    bool trace = false;
+    string dumpDir;
+    string output;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-g" && i + 1 < argc) grammers.push_back(argv[++i]);
+        else if (arg == "-n" && i + 1 < argc) {
+            if (!parseSizes(argv[++i], sizes)) {
+                usage();
+                return 2;
+            }
+        }
+        else if (arg == "-s" && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-m" && i + 1 < argc) {
+            string name = argv[++i];
+            auto it = find_if(begin(MODES), end(MODES), [&](const pair<SlrTableMode, const char*>& m) { return name == m.second; });
+            if (it == end(MODES)) {
+                usage();
+                return 2;
+            }
+            mode = it->first;
+        }
+        else if (arg == "-G") glr = true;
+        else if (arg == "-t") trace = true;
+        else if (arg == "-w" && i + 1 < argc) dumpDir = argv[++i];
+        else if (arg == "-o" && i + 1 < argc) output = argv[++i];
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (grammers.empty()) grammers = { LR_SLR_TEST_DIR "/minic.txt", LR_SLR_TEST_DIR "/tiny-bnf.txt" };
+
+    ofstream file;
+    if (output.size()) {
+        file.open(output, ios::out | ios::binary);
+        if (!file.is_open()) {
+            cerr << output << ": cannot open output file\n";
+            return 2;
+        }
+    }
+    ostream& os = output.size() ? file : cout;
+    int failed = 0;
+    bool first = true;
+    os << "{\"benchmark\":\"slr-parse\",\"seed\":" << seed << ",\"mode\":" << quote(find_if(begin(MODES), end(MODES), [&](const pair<SlrTableMode, const char*>& m) { return m.first == mode; })->second)
+        << ",\"glr\":" << (glr ? "true" : "false")
+        << ",\"trace\":" << (trace ? "true" : "false") << ",\"results\":[";
+    for (const string& path : grammers) {
+        string name = path.substr(path.find_last_of("/\\") + 1);
+        string text;
+        bool readable = readFile(path, text);
+        for (size_t size : sizes) {
+            string json, error;
+            long peak = -1;
+            string dump;
+            if (dumpDir.size()) dump = dumpDir + "/" + name.substr(0, name.find_last_of('.')) + "-" + to_string(size) + ".lex";
+            cerr << name << " " << size << "...";
+            bool ok = readable ? runIsolated(text, mode, size, seed, glr, trace, dump, json, peak, error) : (error = "cannot open " + path, false);
+            if (!first) os << ',';
+            first = false;
+            os << "\n{\"grammar\":" << quote(name) << ",\"size\":" << size;
+            if (ok) {
+                os << ',' << json << ",\"peak_rss_kb\":" << rssJson(peak);
+                // 用例内部的错误（文法错误、输入被拒绝）也算失败
+                if (json.find("\"error\"") != string::npos) {
+                    failed++;
+                    cerr << " rejected\n";
+                }
+                else {
+                    cerr << " ok\n";
+                }
+            }
+            else {
+                os << ",\"error\":" << quote(error);
+                cerr << " " << error << '\n';
+                failed++;
+            }
+            os << '}';
+            os.flush();
+        }
+    }
+    // 三种构造方法的分析表对比，在当前进程中生成
+    os << "\n],\"tables\":[";
+    first = true;
+    for (const string& path : grammers) {
+        string text;
+        if (!readFile(path, text)) continue;
+        if (!first) os << ',';
+        first = false;
+        os << "\n{\"grammar\":" << quote(path.substr(path.find_last_of("/\\") + 1)) << ",\"modes\":" << compareTables(text) << '}';
+    }
+    os << "\n]}\n";
+    return failed ? 1 : 0;
+}
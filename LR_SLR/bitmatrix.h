@@ -0,0 +1,81 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 23:19:42
+ * @LastEditTime: 2026-10-19 23:27:05
+ * @FilePath: /LR_SLR/bitmatrix.h
+ * @Description: 按行存放的定长位集合，用于按编号的集合运算（项目集闭包、First/Follow 集合等）
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#ifndef BITMATRIX_H
+#define BITMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// rows 行、每行 bits 位的位集合，行数据连续存放
+class BitMatrix {
+public:
+    BitMatrix() {}
+    BitMatrix(size_t rows, size_t bits) : words((bits + 63) / 64), data(rows * words) {}
+
+    // 每行的字数
+    size_t rowWords() const { return words; }
+    uint64_t* row(size_t r) { return data.data() + r * words; }
+    const uint64_t* row(size_t r) const { return data.data() + r * words; }
+
+    bool test(size_t r, size_t bit) const {
+        return (row(r)[bit / 64] >> (bit % 64)) & 1;
+    }
+    void set(size_t r, size_t bit) {
+        row(r)[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+    // 第 dst 行改为与第 src 行相同
+    void copy(size_t dst, size_t src) {
+        for (size_t i = 0; i < words; ++i) row(dst)[i] = row(src)[i];
+    }
+    // 第 dst 行并上第 src 行，有新增位时返回 true
+    bool unite(size_t dst, size_t src) {
+        return unite(row(dst), row(src), words);
+    }
+
+    // dst 并上 src，有新增位时返回 true
+    static bool unite(uint64_t* dst, const uint64_t* src, size_t words) {
+        uint64_t added = 0;
+        for (size_t i = 0; i < words; ++i) {
+            added |= src[i] & ~dst[i];
+            dst[i] |= src[i];
+        }
+        return added != 0;
+    }
+
+    // 按位升序对每个置位的位调用 visit(bit)
+    template <class Visit>
+    static void forEach(const uint64_t* row, size_t words, Visit visit) {
+        for (size_t i = 0; i < words; ++i) {
+            for (uint64_t word = row[i]; word; word &= word - 1) {
+                visit(i * 64 + lowestBit(word));
+            }
+        }
+    }
+
+private:
+    size_t words = 0;
+    std::vector<uint64_t> data;
+
+    // 最低置位的位置，word 不为0
+    static int lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return (int)index;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+};
+
+#endif // BITMATRIX_H
@@ -0,0 +1,386 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 23:55:07
+ * @LastEditTime: 2026-10-19 23:58:44
+ * @FilePath: /LR_SLR/glrparse.cpp
+ * @Description: GLR 分析：图结构栈在分析表的冲突处分叉，推导放在共享的压缩分析森林中
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#include "grammer.h"
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    // 图结构栈的节点：读入第 position 个记号之前所处的状态，同一位置上同一状态只有一个节点
+    struct GssNode {
+        int32_t state;
+        int32_t position;
+        int32_t edges; // 第一条边，-1 为无
+    };
+
+    // 图结构栈的边：指向栈中下一层的节点，带着两节点之间的符号在分析森林中的节点
+    struct GssEdge {
+        int32_t target;
+        int32_t symbol;
+        int32_t next; // 同一节点的下一条边
+    };
+
+    // 分析森林的符号节点：符号推导出记号区间 [begin, end)，终结符号节点没有推导
+    struct SppfNode {
+        int32_t symbol; // 终结符号为其编号，非终结符号为终结符号数 + 其编号
+        int32_t begin;
+        int32_t end;
+        int32_t packed; // 最先得到的推导，-1 为无
+    };
+
+    // 符号节点的一种推导：产生式和右部各符号（不含 EPSILON）的节点
+    struct SppfPacked {
+        int32_t production;
+        int32_t children; // 右部节点在 GlrParser::children 中的起始下标
+        int32_t next; // 同一符号节点的下一种推导
+    };
+
+    // 在当前位置结束的符号节点，按非终结符号串成链表
+    struct SymbolEntry {
+        int32_t begin;
+        int32_t symbol;
+        int32_t next;
+    };
+
+    // 待执行的规约：从 node 出发沿长度为右部长度的路径规约，required 不为-1 时只走经过该边的路径
+    struct GlrReduction {
+        int32_t node;
+        int32_t action; // 规约或接受，编码同 SlrTable::action
+        int32_t required;
+    };
+
+    /**
+     * Tomita 式 GLR 分析器（Rekers 的做法）：每读入一个记号，先对当前位置的全部节点做完所有规约，再一起移进
+     * 规约得到的状态在当前位置已有节点时共用该节点（栈共享），只需补一条边；
+     * 补边后已执行过规约的节点经过新边的路径另行规约，空产生式规约出的边保证了这些路径都在当前位置以内
+     * 同一位置上相同符号、相同起点的推导归入同一个符号节点（局部歧义压缩）
+     */
+    class GlrParser {
+    public:
+        vector<GssNode> nodes;
+        vector<GssEdge> edges;
+        vector<SppfNode> forest;
+        vector<SppfPacked> packs;
+        vector<int32_t> children;
+        vector<InputToken> tokens; // 已移进的记号，下标即其位置
+        int32_t root = -1; // 接受时起始符号推导出全部记号的节点
+        size_t shifts = 0; // 移进的边数
+        size_t reductions = 0; // 规约的路径数
+
+        GlrParser(const SlrTable& table, int endId)
+            : table(table), endId(endId), frontierOf(table.stateCount, -1), symbolsOf(table.nonterminalCount, -1) {
+            newNode(0);
+        }
+
+        // 在当前位置上按终结符号 terminal 执行全部规约
+        void reduce(int terminal) {
+            this->terminal = terminal;
+            size_t count = frontier.size();
+            for (size_t i = 0; i < count; ++i) act(frontier[i], -1);
+            while (pending.size()) {
+                GlrReduction reduction = pending.back();
+                pending.pop_back();
+                reduceFrom(reduction);
+            }
+        }
+
+        // 移进 token 到下一个位置，没有节点能移进时返回false
+        bool shift(const InputToken& token) {
+            if (shiftable.empty()) return false;
+            int32_t leaf = forest.size();
+            forest.push_back(SppfNode{ terminal, position, position + 1, -1 });
+            tokens.push_back(token);
+            for (int32_t node : frontier) frontierOf[nodes[node].state] = -1;
+            frontier.clear();
+            for (auto& entry : symbols) symbolsOf[entry.first] = -1;
+            symbols.clear();
+            position++;
+            for (auto& it : shiftable) {
+                shifts++;
+                int32_t node = frontierOf[it.second];
+                if (node < 0) node = newNode(it.second);
+                addEdge(node, it.first, leaf);
+            }
+            shiftable.clear();
+            return true;
+        }
+
+        // 当前位置上各节点的状态，用于报错
+        string frontierStates() const {
+            stringstream ss;
+            for (size_t i = 0; i < frontier.size(); ++i) {
+                if (i) ss << ", ";
+                ss << nodes[frontier[i]].state;
+            }
+            return ss.str();
+        }
+
+    private:
+        const SlrTable& table;
+        int endId;
+        int terminal = -1; // 当前记号的终结符号编号
+        int32_t position = 0; // 当前记号的位置
+        vector<int32_t> frontier; // 当前位置的节点
+        vector<int32_t> frontierOf; // 状态 -> 当前位置上该状态的节点，-1 为无
+        vector<int32_t> symbolsOf; // 非终结符号 -> 当前位置结束的符号节点链表，-1 为无
+        vector<pair<int32_t, SymbolEntry> > symbols; // (非终结符号, 链表项)，换位置时清空
+        vector<GlrReduction> pending; // 规约的先后不影响结果，按栈处理
+        vector<pair<int32_t, int32_t> > shiftable; // (节点, 移进的目标状态)
+        vector<int32_t> path; // 正在枚举的路径上的符号节点，按右部顺序
+        vector<int32_t> foundNodes; // 枚举到的路径终点
+        vector<int32_t> foundPaths; // 枚举到的路径，每条为右部长度个符号节点
+
+        int32_t newNode(int state) {
+            int32_t node = nodes.size();
+            nodes.push_back(GssNode{ state, position, -1 });
+            frontier.push_back(node);
+            frontierOf[state] = node;
+            return node;
+        }
+
+        int32_t addEdge(int32_t from, int32_t to, int32_t symbol) {
+            int32_t edge = edges.size();
+            edges.push_back(GssEdge{ to, symbol, nodes[from].edges });
+            nodes[from].edges = edge;
+            return edge;
+        }
+
+        // 节点在当前记号上的动作：分析表中的动作和冲突中的其余动作，required 不为-1 时只加入经过该边的非空规约
+        void act(int32_t node, int32_t required) {
+            int state = nodes[node].state;
+            auto visit = [&](int32_t entry) {
+                if (SLR_TYPE(entry) == SLR_SHIFT) {
+                    if (required < 0) shiftable.push_back({ node, SLR_VALUE(entry) });
+                    return;
+                }
+                if (required >= 0 && table.productions[SLR_VALUE(entry)].length == 0) return;
+                pending.push_back(GlrReduction{ node, entry, required });
+            };
+            int32_t entry = table.actionOf(state, terminal);
+            if (entry != SLR_ERROR) visit(entry);
+            if (!table.conflictCount) return;
+            auto range = table.conflictsOf(state, terminal);
+            for (const SlrConflict* it = range.first; it != range.second; ++it) visit(it->action);
+        }
+
+        // 从 node 出发还要走 remaining 条边，passed 为是否已经过要求的边
+        void walk(int32_t node, int remaining, bool passed, int32_t required) {
+            if (remaining == 0) {
+                if (!passed) return;
+                foundNodes.push_back(node);
+                foundPaths.insert(foundPaths.end(), path.begin(), path.end());
+                return;
+            }
+            for (int32_t edge = nodes[node].edges; edge >= 0; edge = edges[edge].next) {
+                path[remaining - 1] = edges[edge].symbol;
+                walk(edges[edge].target, remaining - 1, passed || edge == required, required);
+            }
+        }
+
+        // 先枚举出全部路径再规约，规约时新增的边不影响正在进行的枚举
+        void reduceFrom(const GlrReduction& reduction) {
+            int length = table.productions[SLR_VALUE(reduction.action)].length;
+            path.assign(length, -1);
+            foundNodes.clear();
+            foundPaths.clear();
+            walk(reduction.node, length, reduction.required < 0, reduction.required);
+            for (size_t i = 0; i < foundNodes.size(); ++i) {
+                reducePath(reduction.action, foundNodes[i], foundPaths.data() + i * length);
+            }
+        }
+
+        // 规约到 node 下方：右部为 labels，左部接在 node 上
+        void reducePath(int32_t action, int32_t node, const int32_t* labels) {
+            reductions++;
+            int production = SLR_VALUE(action);
+            int key = table.productions[production].key;
+            int32_t symbol = symbolNode(key, nodes[node].position);
+            addPacked(symbol, production, labels);
+            // 起始符号推导出全部记号
+            if (SLR_TYPE(action) == SLR_ACCEPT && terminal == endId && node == 0) root = symbol;
+            int state = table.gotoOf(nodes[node].state, key);
+            if (state < 0) return;
+            int32_t target = frontierOf[state];
+            if (target < 0) {
+                target = newNode(state);
+                addEdge(target, node, symbol);
+                act(target, -1);
+                return;
+            }
+            // 状态的入口符号唯一，两节点之间已有的边上就是同一个符号节点
+            for (int32_t edge = nodes[target].edges; edge >= 0; edge = edges[edge].next) {
+                if (edges[edge].target == node) return;
+            }
+            int32_t edge = addEdge(target, node, symbol);
+            // 只有 target 本身和能经空产生式的边到达当前位置的节点才可能走到新边
+            for (int32_t other : frontier) {
+                if (other == target || reachesFrontier(other)) act(other, edge);
+            }
+        }
+
+        bool reachesFrontier(int32_t node) const {
+            for (int32_t edge = nodes[node].edges; edge >= 0; edge = edges[edge].next) {
+                if (nodes[edges[edge].target].position == position) return true;
+            }
+            return false;
+        }
+
+        // 当前位置结束、从 begin 开始的非终结符号 key 的节点，没有时新建
+        int32_t symbolNode(int key, int32_t begin) {
+            for (int32_t entry = symbolsOf[key]; entry >= 0; entry = symbols[entry].second.next) {
+                if (symbols[entry].second.begin == begin) return symbols[entry].second.symbol;
+            }
+            int32_t symbol = forest.size();
+            forest.push_back(SppfNode{ table.terminalCount + key, begin, position, -1 });
+            symbols.push_back({ key, SymbolEntry{ begin, symbol, symbolsOf[key] } });
+            symbolsOf[key] = symbols.size() - 1;
+            return symbol;
+        }
+
+        // 加入一种推导，已有相同的推导时忽略；新推导接在最先得到的推导之后
+        void addPacked(int32_t symbol, int production, const int32_t* labels) {
+            int length = table.productions[production].length;
+            int32_t first = forest[symbol].packed;
+            for (int32_t packed = first; packed >= 0; packed = packs[packed].next) {
+                if (packs[packed].production == production
+                    && equal(labels, labels + length, children.begin() + packs[packed].children)) return;
+            }
+            int32_t packed = packs.size();
+            packs.push_back(SppfPacked{ production, (int32_t)children.size(), -1 });
+            children.insert(children.end(), labels, labels + length);
+            if (first < 0) forest[symbol].packed = packed;
+            else {
+                packs[packed].next = packs[first].next;
+                packs[first].next = packed;
+            }
+        }
+    };
+}
+
+// 根据记号流按 GLR 分析，再按最先得到的推导和语义动作生成语法树
+ParsedResult Grammer::parseGlr(TokenStream& tokens, const string& source, const SlrProgress& progress) {
+    SlrStageTimer timer(&stats.parse);
+    ParsedResult result;
+    // 当前输入的记号，读完后为结束符
+    InputToken lookahead;
+    size_t consumed = 0; // 已读取的记号数，每读取一批汇报一次进度
+    auto advance = [&]() {
+        if (tokens.next(lookahead)) {
+            if (progress && ++consumed % 1024 == 0) {
+                slrReportProgress(progress, SLR_PROGRESS_PARSE, lookahead.end, source.size());
+            }
+            return true;
+        }
+        result.error = tokens.getError();
+        lookahead = InputToken{ endId, source.size(), source.size() };
+        slrReportProgress(progress, SLR_PROGRESS_PARSE, source.size(), source.size());
+        return result.error.empty();
+    };
+    if (bad() || !table.action) {
+        result.error = "文法有误，无法解析";
+        return result;
+    }
+    if (!advance()) return result;
+    GlrParser parser(table, endId);
+    stringstream ss;
+    for (;;) {
+        if (lookahead.terminal >= 0) parser.reduce(lookahead.terminal);
+        if (lookahead.terminal == endId && parser.root >= 0) {
+            result.accept = true;
+            break;
+        }
+        if (lookahead.terminal < 0 || !parser.shift(lookahead)) {
+            // 所有分析栈都找不到关系，出错，未知的记号用其源文本报错
+            string token = lookahead.terminal >= 0
+                ? terminals[lookahead.terminal]
+                : source.substr(lookahead.begin, lookahead.end - lookahead.begin);
+            ss << "在状态" << parser.frontierStates() << "上找不到" << token << "对应的移进/规约关系";
+            result.error = ss.str();
+            break;
+        }
+        if (!advance()) break;
+    }
+    result.shifts = parser.shifts;
+    result.reductions = parser.reductions;
+    stats.shifts += parser.shifts;
+    stats.reductions += parser.reductions;
+    stats.stackNodes += parser.nodes.size();
+    stats.forestNodes += parser.forest.size();
+    if (!result.accept || result.error.size()) return result;
+
+    // 语法树所在的分析森林中有多种推导的节点
+    vector<char> visited(parser.forest.size());
+    vector<int32_t> prepared(1, parser.root);
+    visited[parser.root] = 1;
+    while (prepared.size()) {
+        const SppfNode& node = parser.forest[prepared.back()];
+        prepared.pop_back();
+        if (node.packed >= 0 && parser.packs[node.packed].next >= 0) result.ambiguities++;
+        for (int32_t packed = node.packed; packed >= 0; packed = parser.packs[packed].next) {
+            const SppfPacked& alternative = parser.packs[packed];
+            int length = table.productions[alternative.production].length;
+            for (int i = 0; i < length; ++i) {
+                int32_t child = parser.children[alternative.children + i];
+                if (visited[child]) continue;
+                visited[child] = 1;
+                prepared.push_back(child);
+            }
+        }
+    }
+    stats.ambiguities += result.ambiguities;
+
+    // 在工作区的TreeNode，出错或取消提前返回时统一释放
+    vector<TreeNode*> workspace;
+    struct WorkspaceGuard {
+        vector<TreeNode*>& nodes;
+        ~WorkspaceGuard() {
+            if (nodes.empty()) return;
+            TreeNode* holder = new TreeNode;
+            holder->children.swap(nodes);
+            freeTree(holder);
+        }
+    } guard{ workspace };
+    // 后序遍历最先得到的推导，与确定的分析按同样的顺序规约
+    // 符号节点的第一种推导在创建节点时加入，其右部节点都先于它创建，因此不会成环
+    struct Frame {
+        int32_t packed;
+        int child; // 下一个要展开的右部节点
+    };
+    vector<Frame> frames(1, Frame{ parser.forest[parser.root].packed, 0 });
+    while (frames.size()) {
+        const SppfPacked& packed = parser.packs[frames.back().packed];
+        if (frames.back().child < table.productions[packed.production].length) {
+            const SppfNode& node = parser.forest[parser.children[packed.children + frames.back().child++]];
+            if (node.symbol >= table.terminalCount) {
+                frames.push_back(Frame{ node.packed, 0 });
+                continue;
+            }
+            const InputToken& token = parser.tokens[node.begin];
+            TreeNode* leaf = new TreeNode;
+            leaf->label = terminals[node.symbol];
+            leaf->value = source.substr(token.begin, token.end - token.begin);
+            workspace.push_back(leaf);
+            continue;
+        }
+        int production = packed.production;
+        frames.pop_back();
+        if (!reduceTree(production, workspace, result.error)) {
+            result.accept = false;
+            return result;
+        }
+    }
+    if (workspace.size() != 1) {
+        result.error = "语法树解析错误，规约树不唯一";
+        return result;
+    }
+    result.root = workspace[0];
+    workspace.pop_back();
+    return result;
+}
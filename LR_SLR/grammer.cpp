@@ -1,12 +1,27 @@
 /*
  * @Author: 20212131001 翁行
  * @Date: 2023-12-16 22:04:11
- * @LastEditTime: 2024-05-25 00:21:21
+ * @LastEditTime: 2026-10-19 23:59:58
  * @FilePath: /LR_SLR/grammer.cpp
  * @Description: 文法解析、DFA生成、语法树生成 ALL in one
  * Copyright (c) 2024 by wengx00, All Rights Reserved.
  *
  * 版本历史
+ * 2026/10/19 fix: 规约-规约冲突按产生式编号取先出现的产生式，语法分析不读入记号的规约陷入循环时报错
+ * 2026/10/19 fix: 读取缓存时校验语义动作下标，并逐条核对产生式
+ * 2026/10/19 feat: GLR 分析（图结构栈、共享压缩分析森林），分析表保留冲突中的其余动作
+ * 2026/10/19 feat: LR(1) 分析表（项目带向前看集合，Pager 弱相容时合并同核心状态）
+ * 2026/10/19 feat: LALR(1) 分析表（DeRemer-Pennello 向前看集合），移进-规约冲突也记入原因
+ * 2026/10/19 perf: First、Follow集合改为位集合，在依赖图上按强连通分量一次求出（DeRemer-Pennello digraph）
+ * 2026/10/19 perf: 预先求出各非终结符号的闭包（产生式位集合），扩展项目集时只做位集合的并
+ * 2026/10/19 perf: 按核心项目签名在哈希表中查找已有状态，只匹配完全相同的项目集
+ * 2026/10/19 perf: 生成DFA时直接写入 ACTION、GOTO 表，去掉按状态和符号嵌套的移进、规约关系表
+ * 2026/10/19 perf: 符号按编号分析，First、Follow集合和DFA的生成不再比较字符串
+ * 2026/10/19 feat: 进度回调和取消，语法分析提前返回时释放语法树
+ * 2026/10/19 feat: 各阶段耗时和计数统计
+ * 2026/10/19 feat: 扁平分析表和按文法哈希的分析表缓存，parse 直接读取分析表
+ * 2026/10/19 feat: 终结符号编号和记号流输入，支持进程内直接对接 XLEX 分词
+ * 2026/10/19 feat: 拆分为不依赖 Qt 的 libslr 静态库，去除调试输出
  * 2024/5/23 feat: 语法树自动展开和TAB切换
  * 2024/5/22 fix: 语义规则解析问题修复
  * 2024/5/21 feat：显示语法树
@@ -17,14 +32,17 @@
  * 2024/5/18 feat: 复用上学期编译原理实验 LR_SLR 源代码
  */
 #include "grammer.h"
-#include <iostream>
+#include "slrcache.h"
+#include <algorithm>
+#include <climits>
 #include <queue>
 #include <sstream>
 
 using namespace std;
 
 // 根据字符串输入构造文法、DFA、SLR表
-Grammer::Grammer(string input) {
+Grammer::Grammer(string input, const string& cacheDir, const SlrProgress& progress, SlrTableMode mode) : mode(mode) {
+    SlrStageTimer grammarTimer(&stats.grammar);
     vector<string> lines;
     int from = 0, i = 0;
     for (i = 0; i < input.size(); ++i) {
@@ -168,283 +186,934 @@ Grammer::Grammer(string input) {
         }
     }
 
+    // 终结符号编号，结束符排在最后
+    for (const auto& token : endSet) {
+        terminalIds[token] = terminals.size();
+        terminals.push_back(token);
+    }
+    endId = terminals.size();
+    terminalIds[END_FLAG] = endId;
+    terminals.push_back(END_FLAG);
+
+    // 非终结符号编号
+    for (const auto& token : notEnd) {
+        nonterminalIds[token] = nonterminals.size();
+        nonterminals.push_back(token);
+    }
+    // 产生式编号，同一非终结符号的产生式编号连续
+    for (auto& p : formula) {
+        productionBase.push_back(productions.size());
+        for (int i = 0; i < p.second.size(); ++i) {
+            productions.push_back(make_pair(p.first, i));
+            vector<int> symbols;
+            for (auto& raw : p.second[i]) symbols.push_back(symbolId(raw));
+            productionSymbols.push_back(symbols);
+        }
+    }
+    productionBase.push_back(productions.size());
+    epsilonId = terminalId(EPSILON);
+    startId = nonterminalId(start);
+    if (startId < 0) {
+        // 第一条文法没有推导式
+        error = "文法输入有误";
+        return;
+    }
+
+    grammarTimer.stop();
+
+    string path, cacheError;
+    uint64_t hash = hashGrammerText(input, mode);
+    vector<vector<int> > bodies; // 各产生式的左部和右部，与缓存中的核对
+    if (cacheDir.size()) {
+        SlrStageTimer timer(&stats.cache);
+        path = slrCachePath(cacheDir, input, mode);
+        for (int i = 0; i < productions.size(); ++i) {
+            bodies.push_back(vector<int>(1, nonterminalIds[productions[i].first]));
+            bodies.back().insert(bodies.back().end(), productionSymbols[i].begin(), productionSymbols[i].end());
+        }
+        SlrCacheMeta meta;
+        // 哈希相同时再核对一遍符号和各产生式，防止碰撞
+        if (loadSlrCache(path, hash, table, meta, cacheError)
+            && meta.terminals == terminals && meta.nonterminals == nonterminals
+            && table.productionCount == (int)productions.size() && meta.productions == bodies) {
+            isSLR = meta.slr;
+            reason = meta.reason;
+            cached = true;
+            stats.cached = true;
+            stats.states = table.stateCount;
+            return;
+        }
+        table = SlrTable();
+    }
+    analyze(progress);
+    slrReportProgress(progress, SLR_PROGRESS_TABLE, 0, 1);
+    initTable();
+    // 缓存写入失败不影响使用
+    if (cacheDir.size()) {
+        SlrStageTimer timer(&stats.cache);
+        SlrCacheMeta meta{ terminals, nonterminals, isSLR, reason, bodies };
+        saveSlrCache(path, hash, table, meta, cacheError);
+    }
+    slrReportProgress(progress, SLR_PROGRESS_TABLE, 1, 1);
+}
+// 生成First、Follow集合和DFA
+void Grammer::analyze(const SlrProgress& progress) {
+    if (analyzed || bad()) return;
+    analyzed = true;
+    // 命中缓存时原因已从缓存读出，重新生成
+    reason.clear();
     // 初始化First集合元素
-    initFirst();
+    slrReportProgress(progress, SLR_PROGRESS_FIRST, 0, 1);
+    {
+        SlrStageTimer timer(&stats.first);
+        initFirst();
+    }
+    slrReportProgress(progress, SLR_PROGRESS_FIRST, 1, 1);
     // 初始化Follow集合元素
-    initFollow();
+    slrReportProgress(progress, SLR_PROGRESS_FOLLOW, 0, 1);
+    {
+        SlrStageTimer timer(&stats.follow);
+        initFollow();
+    }
+    slrReportProgress(progress, SLR_PROGRESS_FOLLOW, 1, 1);
     // 构建DFA
-    initRelation();
-    // 判断是否SLR
-    // initIsSLR();
+    {
+        SlrStageTimer timer(&stats.automaton);
+        initClosure();
+        if (mode == SLR_MODE_LR1) initLr1Relation(progress);
+        else initRelation(progress);
+    }
+    slrReportProgress(progress, SLR_PROGRESS_AUTOMATON, dfa.size(), dfa.size());
+    // 规约项目的向前看集合：SLR(1) 直接使用左部的Follow集合，LALR(1) 在DFA上另行求出，LR(1) 在生成DFA时已求出
+    {
+        SlrStageTimer timer(&stats.lookahead);
+        if (mode == SLR_MODE_LALR) {
+            slrReportProgress(progress, SLR_PROGRESS_LOOKAHEAD, 0, 3);
+            initLookahead(progress);
+            slrReportProgress(progress, SLR_PROGRESS_LOOKAHEAD, 3, 3);
+        }
+        initReduce();
+    }
+    // 命中缓存时分析表已从缓存读出，重新生成的表不再需要
+    if (cached) {
+        vector<int32_t>().swap(actionRows);
+        vector<int32_t>().swap(gotoRows);
+        vector<SlrConflict>().swap(conflictRows);
+    }
 }
 // 获取First集合
 set<string> Grammer::getFirst(string key) {
-    if (!notEnd.count(key)) {
+    analyze();
+    int id = nonterminalId(key);
+    set<string> res;
+    if (id < 0) {
         // 是终结节点
-        set<string> res;
         res.insert(key);
         return res;
     }
     // 非终结节点，返回其First集
-    return first[key];
+    if (nullable.empty()) return res;
+    BitMatrix::forEach(first.row(id), first.rowWords(), [&](size_t el) {
+        res.insert(terminals[el]);
+    });
+    if (nullable[id]) res.insert(EPSILON);
+    return res;
 }
 // 获取Follow集合
-set<string> Grammer::getFollow(string key) { return follow[key]; }
-// 生成First集合
-void Grammer::initFirst() {
-    bool shouldUpdate = true;
-    while (shouldUpdate) {
-        shouldUpdate = false;
-
-        for (auto& p : formula) {
-            string key = p.first;                   // 非终结符
-            vector<vector<string>> raws = p.second; // 产生式右侧
-            for (const auto& raw : raws) {
-                int cur = 0;
-                for (; cur < raw.size(); ++cur) {
-                    auto firstOfCur = getFirst(raw[cur]); // 当前元素的First集合
-
-                    // 遍历当前First
-                    for (auto& el : firstOfCur) {
-                        // 除了EPSILON外，新增的元素都加入key的First
-                        if (el != EPSILON && !first[key].count(el)) {
-                            first[key].insert(el);
-                            shouldUpdate = true;
-                        }
+set<string> Grammer::getFollow(string key) {
+    analyze();
+    int id = nonterminalId(key);
+    set<string> res;
+    if (id < 0 || nullable.empty()) return res;
+    BitMatrix::forEach(follow.row(id), follow.rowWords(), [&](size_t el) {
+        res.insert(terminals[el]);
+    });
+    return res;
+}
+namespace {
+    /**
+     * DeRemer-Pennello digraph：在关系图上求 F(x) = F'(x) ∪ ⋃{ F(y) | x -> y }
+     * sets 的第 x 行开始时为 F'(x)，结束时为 F(x)；同一强连通分量内的集合相同，每条边只合并一次
+     * 用显式栈代替递归，返回强连通分量数
+     */
+    size_t digraph(const vector<vector<int> >& edges, BitMatrix& sets) {
+        struct Frame {
+            int node;
+            size_t next; // 下一条待访问的边
+            int depth; // 入栈时的深度
+        };
+        int n = edges.size();
+        vector<int> depth(n, 0); // 0 为未访问，INT_MAX 为所在分量已完成
+        vector<int> stack;
+        vector<Frame> frames;
+        size_t components = 0;
+        for (int root = 0; root < n; ++root) {
+            if (depth[root]) continue;
+            stack.push_back(root);
+            depth[root] = stack.size();
+            frames.push_back(Frame{ root, 0, depth[root] });
+            while (frames.size()) {
+                Frame& frame = frames.back();
+                int x = frame.node;
+                if (frame.next < edges[x].size()) {
+                    int y = edges[x][frame.next++];
+                    if (depth[y] == 0) {
+                        stack.push_back(y);
+                        depth[y] = stack.size();
+                        frames.push_back(Frame{ y, 0, depth[y] });
+                        continue;
                     }
-
-                    // EPSILON不在cur的First，可以退出推导式右侧的遍历
-                    if (!firstOfCur.count(EPSILON)) {
-                        break;
+                    depth[x] = min(depth[x], depth[y]);
+                    sets.unite(x, y);
+                    continue;
+                }
+                int entered = frame.depth;
+                frames.pop_back();
+                if (depth[x] == entered) {
+                    // x 是强连通分量的根，分量内的集合都与 x 相同
+                    components++;
+                    for (;;) {
+                        int y = stack.back();
+                        stack.pop_back();
+                        depth[y] = INT_MAX;
+                        if (y == x) break;
+                        sets.copy(y, x);
                     }
                 }
-                // 右侧所有元素First都包含EPSILON，则key的First也应该包含EPSILON
-                if (cur == raw.size() && !first[key].count(EPSILON)) {
-                    first[key].insert(EPSILON);
-                    shouldUpdate = true;
+                if (frames.size()) {
+                    int parent = frames.back().node;
+                    depth[parent] = min(depth[parent], depth[x]);
+                    sets.unite(parent, x);
+                }
+            }
+        }
+        return components;
+    }
+
+    // 两行位集合是否相交
+    bool intersects(const uint64_t* a, const uint64_t* b, size_t words) {
+        for (size_t i = 0; i < words; ++i) {
+            if (a[i] & b[i]) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Pager 的弱相容：a、b 为同核心两个状态的核心项目向前看集合（每个项目 words 个字）
+     * 任意两个项目 i、j，若 a 的 i 与 b 的 j（或 b 的 i 与 a 的 j）相交，则 i、j 已在 a 或 b 内相交，此时合并不会产生新的规约冲突
+     */
+    bool weaklyCompatible(const vector<uint64_t>& a, const vector<uint64_t>& b, int items, size_t words) {
+        for (int i = 0; i < items; ++i) {
+            for (int j = i + 1; j < items; ++j) {
+                const uint64_t* ai = &a[i * words];
+                const uint64_t* aj = &a[j * words];
+                const uint64_t* bi = &b[i * words];
+                const uint64_t* bj = &b[j * words];
+                if (!intersects(ai, bj, words) && !intersects(bi, aj, words)) continue;
+                if (!intersects(ai, aj, words) && !intersects(bi, bj, words)) return false;
+            }
+        }
+        return true;
+    }
+}
+// 求出能推导出空串的非终结符号：右部符号都能推导出空串的产生式倒数到0时，其左部能推导出空串
+void Grammer::initNullable() {
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
+    nullable.assign(nonterminalCount, 0);
+    vector<int> remaining(productions.size()); // 产生式右部尚未确定能推导出空串的非终结符号数，-1 为含有终结符号
+    vector<vector<pair<int, int> > > users(nonterminalCount); // 非终结符号 -> 右部每次出现它的 (产生式, 左部)
+    vector<int> prepared;
+    for (int key = 0; key < nonterminalCount; ++key) {
+        for (int p = productionBase[key]; p < productionBase[key + 1]; ++p) {
+            for (int symbol : productionSymbols[p]) {
+                if (symbol >= terminalCount) {
+                    users[symbol - terminalCount].push_back(make_pair(p, key));
+                    if (remaining[p] >= 0) remaining[p]++;
+                }
+                else if (symbol != epsilonId) remaining[p] = -1;
+            }
+            if (remaining[p] == 0 && !nullable[key]) {
+                nullable[key] = 1;
+                prepared.push_back(key);
+            }
+        }
+    }
+    while (prepared.size()) {
+        int cur = prepared.back();
+        prepared.pop_back();
+        for (auto& use : users[cur]) {
+            if (remaining[use.first] <= 0 || --remaining[use.first] > 0 || nullable[use.second]) continue;
+            nullable[use.second] = 1;
+            prepared.push_back(use.second);
+        }
+    }
+}
+// 生成First集合：First(A) 含 A 的右部中前缀可空的终结符号，并包含前缀可空的非终结符号的First集合
+void Grammer::initFirst() {
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
+    initNullable();
+    first = BitMatrix(nonterminalCount, terminalCount);
+    vector<vector<int> > edges(nonterminalCount); // A -> B：First(A) 包含 First(B)
+    for (int key = 0; key < nonterminalCount; ++key) {
+        for (int p = productionBase[key]; p < productionBase[key + 1]; ++p) {
+            for (int symbol : productionSymbols[p]) {
+                if (symbol < terminalCount) {
+                    // 终结符号的First是其本身，EPSILON的First只有EPSILON
+                    if (symbol == epsilonId) continue;
+                    first.set(key, symbol);
+                    break;
                 }
+                edges[key].push_back(symbol - terminalCount);
+                // EPSILON不在symbol的First，可以退出推导式右侧的遍历
+                if (!nullable[symbol - terminalCount]) break;
             }
         }
     }
+    stats.firstComponents = digraph(edges, first);
 }
-// 生成Follow集合
+// 生成Follow集合：B 之后的符号串的First集合加入 Follow(B)，符号串可空时 Follow(B) 包含左部的Follow集合
 void Grammer::initFollow() {
-    bool shouldUpdate = true;
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
+    follow = BitMatrix(nonterminalCount, terminalCount);
     // start的Follow为END_FLAG
-    follow[start].insert(END_FLAG);
-    while (shouldUpdate) {
-        shouldUpdate = false;
-
-        for (auto& p : formula) {
-            string key = p.first;
-            vector<vector<string>> raws = p.second;
-            // 遍历每一个推导式右侧
-            for (const auto& raw : raws) {
-                // 遍历每一个非终结符号
-                for (int i = 0; i < raw.size(); ++i) {
-                    if (!notEnd.count(raw[i]))
-                        continue;
-                    // 末尾
-                    if (i == raw.size() - 1) {
-                        for (const auto& el : getFollow(key)) {
-                            if (!follow[raw[i]].count(el)) {
-                                follow[raw[i]].insert(el);
-                                shouldUpdate = true;
-                            }
-                        }
-                        continue;
-                    }
-                    // 非末尾，获取后续元素的First集合
-                    set<string> firstOfBehind;
-                    int cur = i + 1;
-                    for (; cur < raw.size(); ++cur) {
-                        set<string> firstOfCur = getFirst(raw[cur]);
-                        for (const auto& el : firstOfCur) {
-                            if (el != EPSILON)
-                                firstOfBehind.insert(el);
-                        }
-                        if (!firstOfCur.count(EPSILON)) {
-                            // 不含EPSILON，First终止
-                            break;
-                        }
-                    }
-                    if (cur == raw.size()) {
-                        // 每个元素的First都包含Epsilon
-                        firstOfBehind.insert(EPSILON);
-                    }
-                    // 更新Follow集合
-                    for (const auto& el : firstOfBehind) {
-                        if (el != EPSILON && !follow[raw[i]].count(el)) {
-                            follow[raw[i]].insert(el);
-                            shouldUpdate = true;
-                        }
-                    }
-                    if (firstOfBehind.count(EPSILON)) {
-                        follow[raw[i]].erase(EPSILON);
-                        // 包含EPSILON，Follow集合包含产生式左侧的Follow集合
-                        for (const auto& el : getFollow(key)) {
-                            if (!follow[raw[i]].count(el)) {
-                                follow[raw[i]].insert(el);
-                                shouldUpdate = true;
-                            }
-                        }
+    follow.set(startId, endId);
+    vector<vector<int> > edges(nonterminalCount); // B -> A：Follow(B) 包含 Follow(A)
+    for (int key = 0; key < nonterminalCount; ++key) {
+        for (int p = productionBase[key]; p < productionBase[key + 1]; ++p) {
+            const vector<int>& raw = productionSymbols[p];
+            // 遍历每一个非终结符号
+            for (int i = 0; i < raw.size(); ++i) {
+                if (raw[i] < terminalCount)
+                    continue;
+                int cur = raw[i] - terminalCount;
+                int behind = i + 1;
+                for (; behind < raw.size(); ++behind) {
+                    int symbol = raw[behind];
+                    if (symbol < terminalCount) {
+                        if (symbol == epsilonId) continue;
+                        follow.set(cur, symbol);
+                        break;
                     }
+                    BitMatrix::unite(follow.row(cur), first.row(symbol - terminalCount), follow.rowWords());
+                    // 不含EPSILON，First终止
+                    if (!nullable[symbol - terminalCount]) break;
                 }
+                // 位于末尾或每个后续元素的First都包含Epsilon
+                if (behind == raw.size()) edges[cur].push_back(key);
             }
         }
     }
+    stats.followComponents = digraph(edges, follow);
 }
-// 扩展DFA节点
-void Grammer::extend(vector<Item>& nodes) {
-    for (int i = 0; i < nodes.size(); ++i) {
-        Item& node = nodes[i];
-        if (node.type == ItemType::BACKWARD)
-            continue; // 跳过规约节点
-        string cur = formula[node.key][node.rawsIndex][node.rawIndex]; // 指示的符号
-        if (!notEnd.count(cur))
-            continue; // 终结字符不可扩展
-        vector<vector<string>>& rawsOfCur = formula[cur]; // 非终结字符为Key的推导式
-        for (int j = 0; j < rawsOfCur.size(); ++j) {
+// 生成各非终结符号的闭包：它的产生式，以及这些产生式开头的非终结符号的闭包
+void Grammer::initClosure() {
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
+    // 每个产生式的起始项目
+    startItems.clear();
+    for (int key = 0; key < nonterminalCount; ++key) {
+        for (int p = productionBase[key]; p < productionBase[key + 1]; ++p) {
+            const vector<int>& raw = productionSymbols[p];
             int rawOffset = 0;
-            for (; rawOffset < rawsOfCur[j].size(); ++rawOffset) {
+            for (; rawOffset < raw.size(); ++rawOffset) {
                 // 寻找到非空字符
-                if (rawsOfCur[j][rawOffset] != EPSILON)
+                if (raw[rawOffset] != epsilonId)
                     break;
             }
-            // 新增节点，指示了Key对应的第i个推导式的第rawOffset个字符
-            Item instance(cur,
-                rawOffset == 0 ? ItemType::FORWARD : ItemType::BACKWARD, j,
-                rawOffset);
-            // 无重复则扩展state指示的dfa节点
-            if (!count(nodes.begin() /*+ i*/, nodes.end(), instance)) {
-                nodes.push_back(instance);
+            // 指示了Key对应的推导式的第rawOffset个字符
+            startItems.push_back(Item(key,
+                rawOffset == 0 && raw.size() ? ItemType::FORWARD : ItemType::BACKWARD, p - productionBase[key],
+                rawOffset));
+        }
+    }
+    // 从每个非终结符号出发，沿产生式开头的非终结符号遍历
+    closures = BitMatrix(nonterminalCount, productions.size());
+    vector<char> visited(nonterminalCount);
+    vector<int> prepared;
+    for (int key = 0; key < nonterminalCount; ++key) {
+        visited.assign(nonterminalCount, 0);
+        visited[key] = 1;
+        prepared.assign(1, key);
+        while (prepared.size()) {
+            int cur = prepared.back();
+            prepared.pop_back();
+            for (int p = productionBase[cur]; p < productionBase[cur + 1]; ++p) {
+                closures.set(key, p);
+                if (startItems[p].type == ItemType::BACKWARD) continue;
+                int symbol = productionSymbols[p][0];
+                if (symbol < terminalCount || visited[symbol - terminalCount]) continue;
+                visited[symbol - terminalCount] = 1;
+                prepared.push_back(symbol - terminalCount);
             }
         }
     }
 }
+// 扩展DFA节点：核心项目点后的非终结符号的闭包之并
+void Grammer::extend(vector<Item>& nodes) {
+    stats.closures++;
+    int terminalCount = terminals.size();
+    size_t words = closures.rowWords();
+    vector<uint64_t> added(words);
+    for (const Item& node : nodes) {
+        if (node.type == ItemType::BACKWARD)
+            continue; // 跳过规约节点
+        int symbol = itemSymbols(node)[node.rawIndex]; // 指示的符号
+        if (symbol < terminalCount)
+            continue; // 终结字符不可扩展
+        BitMatrix::unite(added.data(), closures.row(symbol - terminalCount), words);
+    }
+    // 已经在项目集中的起始项目（如初始节点的项目）不重复加入
+    for (const Item& node : nodes) {
+        int production = productionBase[node.key] + node.rawsIndex;
+        if (startItems[production] == node) added[production / 64] &= ~((uint64_t)1 << (production % 64));
+    }
+    BitMatrix::forEach(added.data(), words, [&](size_t production) {
+        nodes.push_back(startItems[production]);
+    });
+}
 // 扩展DFA节点
 void Grammer::extend(int state) {
     extend(dfa[state]);
 }
-// 生成DFA
-void Grammer::initRelation() {
+// 生成DFA和 ACTION、GOTO 表中的移进和转移
+void Grammer::initRelation(const SlrProgress& progress) {
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
     // 初始节点 => start指示的推导式的第一条的第一个符号
     vector<Item> beginState;
-    beginState.push_back(Item(start, ItemType::FORWARD, 0, 0));
+    beginState.push_back(Item(startId, ItemType::FORWARD, 0, 0));
+    states.clear();
+    states[itemSetKey(beginState)] = 0;
     dfa.push_back(beginState);
-    isSLR = true; // 暂时先是
+    actionRows.clear();
+    gotoRows.clear();
+    // 当前节点经各符号移进后的核心项目，按符号首次出现的顺序生成下一节点
+    vector<int> groupOf(terminalCount + nonterminalCount, -1); // 符号编号 -> 分组下标
+    vector<int> groupSymbols;
+    vector<vector<Item> > groups;
     // 遍历每一个DFA节点
     for (int cur = 0; cur < dfa.size(); ++cur) {
-        cout << "Current State" << cur << '\n';
+        slrReportProgress(progress, SLR_PROGRESS_AUTOMATON, cur, dfa.size());
         extend(cur); // 扩展当前DFA节点(可能右侧项目含有非终结符号)
-        // forwards[cur]和backwards[cur]分别记录了移进和规约关系
+        // 当前节点的 ACTION、GOTO 行，这里只写入移进和转移，规约在DFA生成后按向前看集合写入
+        actionRows.resize((size_t)(cur + 1) * terminalCount, SLR_ERROR);
+        gotoRows.resize((size_t)(cur + 1) * nonterminalCount, -1);
+        int32_t* action = actionRows.data() + (size_t)cur * terminalCount;
+        int32_t* gotos = gotoRows.data() + (size_t)cur * nonterminalCount;
+        groupSymbols.clear();
+        groups.clear();
         // 遍历DFA节点上的每一个项目
         for (int it = 0; it < dfa[cur].size(); ++it) {
-            Item& item = dfa[cur][it]; // 取出当前项
-            if (formula[item.key][item.rawsIndex][item.rawIndex] == "comma") {
-                cout << "comma\n";
-            }
-            if (item.type == ItemType::BACKWARD) {
-                // 规约项
-                set<string> followOfItem = getFollow(item.key);
-                for (const auto& el : followOfItem) {
-                    if (backwards[cur].count(el)) {
-                        // 存在交集，非SLR(1)
-                        isSLR = false;
-                        stringstream ss;
-                        ss << "第" << cur << "个节点中规约项目的Follow集合有交集\n";
-                        reason += ss.str();
-                    }
-                    backwards[cur][el] = it;
-                }
-                continue;
-            }
+            const Item& item = dfa[cur][it]; // 取出当前项
+            if (item.type == ItemType::BACKWARD)
+                continue; // 规约项
             // 移进项
-            string raw = formula[item.key][item.rawsIndex][item.rawIndex];
+            const vector<int>& raw = itemSymbols(item);
+            int symbol = raw[item.rawIndex];
             // 移进新的节点
             Item instance(item.key, ItemType::FORWARD, item.rawsIndex,
                 item.rawIndex + 1);
-            if (instance.rawIndex >=
-                formula[instance.key][instance.rawsIndex].size()) {
+            if (instance.rawIndex >= raw.size()) {
                 // 超过了该推导式的结尾 -> 变成规约节点
                 instance.type = ItemType::BACKWARD;
             }
-            if (forwards[cur].count(raw)) {
-                // 已经存在该移进关系
-                int target = forwards[cur][raw];
-                vector<Item>& next = dfa[target];
-                if (!count(next.begin(), next.end(), instance)) {
-                    // 如果下一DFA节点中未存在该Instance状态 -> 加入下一DFA节点中
-                    dfa[target].push_back(instance);
-                }
-                continue;
+            if (groupOf[symbol] < 0) {
+                groupOf[symbol] = groups.size();
+                groupSymbols.push_back(symbol);
+                groups.emplace_back();
             }
-            // 未存在该移进关系
-            vector<Item> perhapsNewState{ instance };
-            extend(perhapsNewState);
-            int target = findState(perhapsNewState);
+            groups[groupOf[symbol]].push_back(instance);
+        }
+        for (int group = 0; group < groups.size(); ++group) {
+            int symbol = groupSymbols[group];
+            groupOf[symbol] = -1;
+            int target = findState(groups[group]);
             if (target == -1) {
-                // 该状态不存在于任何DFA节点中 -> 新增一个DFA节点
-                dfa.push_back(perhapsNewState);
-                target = dfa.size() - 1;
+                // 该状态不存在于任何DFA节点中 -> 新增一个DFA节点，处理到它时再扩展
+                target = dfa.size();
+                states[itemSetKey(groups[group])] = target;
+                dfa.push_back(groups[group]);
+            }
+            // 加入移进关系：终结符号移进写入 ACTION 表，非终结符号转移写入 GOTO 表
+            if (symbol < terminalCount) action[symbol] = SLR_ENTRY(SLR_SHIFT, target);
+            else gotos[symbol - terminalCount] = target;
+        }
+    }
+    // 查找表和闭包只在生成DFA时使用
+    unordered_map<ItemSetKey, int, ItemSetKeyHash>().swap(states);
+    closures = BitMatrix();
+    stats.states = dfa.size();
+    stats.items = 0;
+    for (auto& state : dfa) stats.items += state.size();
+}
+/**
+ * 生成LR(1) DFA（Pager 的弱相容合并）：状态为核心项目和每个核心项目的向前看集合，
+ * 转移得到的核心与已有的同核心状态弱相容时并入该状态，否则另建状态；弱相容的合并不会产生规范LR(1)中没有的冲突
+ * 已处理过的状态向前看集合变大时重新处理，把新增的向前看沿已有的转移传给后继
+ * LR(1) 状态的核心项目按 (产生式编号, 推导式内编号) 排序，同核心状态的核心项目一一对应
+ */
+void Grammer::initLr1Relation(const SlrProgress& progress) {
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
+    size_t words = (terminalCount + 63) / 64;
+    // 产生式右部各后缀的First集合和是否可空，产生式 p 从第 i 个符号开始的后缀编号为 suffixBase[p] + i
+    vector<int> suffixBase(productions.size() + 1, 0);
+    for (int p = 0; p < productions.size(); ++p) suffixBase[p + 1] = suffixBase[p] + productionSymbols[p].size() + 1;
+    BitMatrix suffixFirst(suffixBase.back(), terminalCount);
+    vector<char> suffixNullable(suffixBase.back(), 1);
+    for (int p = 0; p < productions.size(); ++p) {
+        const vector<int>& raw = productionSymbols[p];
+        for (int i = (int)raw.size() - 1; i >= 0; --i) {
+            int suffix = suffixBase[p] + i;
+            int symbol = raw[i];
+            if (symbol == epsilonId) {
+                suffixFirst.copy(suffix, suffix + 1);
+                suffixNullable[suffix] = suffixNullable[suffix + 1];
+            }
+            else if (symbol < terminalCount) {
+                suffixFirst.set(suffix, symbol);
+                suffixNullable[suffix] = 0;
+            }
+            else {
+                BitMatrix::unite(suffixFirst.row(suffix), first.row(symbol - terminalCount), words);
+                if (nullable[symbol - terminalCount]) suffixFirst.unite(suffix, suffix + 1);
+                suffixNullable[suffix] = nullable[symbol - terminalCount] && suffixNullable[suffix + 1];
+            }
+        }
+    }
+
+    // 初始节点 => start指示的推导式的第一条的第一个符号，向前看为结束符
+    vector<Item> beginState;
+    beginState.push_back(Item(startId, ItemType::FORWARD, 0, 0));
+    dfa.assign(1, beginState);
+    vector<int> kernelSizes(1, 1); // 状态 -> 核心项目数，dfa 中核心项目在前
+    vector<vector<uint64_t> > kernelLookaheads(1, vector<uint64_t>(words)); // 状态 -> 各核心项目的向前看集合，每个项目 words 个字
+    kernelLookaheads[0][endId / 64] |= (uint64_t)1 << (endId % 64);
+    unordered_map<ItemSetKey, vector<int>, ItemSetKeyHash> isocores; // 核心项目签名 -> 同核心的状态
+    isocores[itemSetKey(beginState)].push_back(0);
+    actionRows.assign(terminalCount, SLR_ERROR);
+    gotoRows.assign(nonterminalCount, -1);
+    vector<char> processed(1, 0); // 是否已扩展并生成转移
+    vector<char> queued(1, 1); // 是否在待处理队列中
+    vector<int> prepared(1, 0); // 待处理队列
+    size_t expanded = 0;
+
+    // 状态中各项目的向前看集合：闭包加入的 B 的项目向前看集合相同，为点在 B 前的各项目的后缀First集合，后缀可空时并上该项目的向前看集合
+    BitMatrix closureLookaheads(nonterminalCount, terminalCount); // 非终结符号 -> 其闭包项目的向前看集合
+    vector<vector<int> > closureEdges(nonterminalCount); // A -> B：B 的闭包项目的向前看集合包含 A 的
+    vector<char> touched(nonterminalCount, 0);
+    vector<int> touchedKeys, changed;
+    vector<uint64_t> itemLookaheads; // 状态中第 i 个项目的向前看集合从 i * words 开始
+    auto lookaheadsOf = [&](int state) {
+        const vector<Item>& items = dfa[state];
+        int kernelSize = kernelSizes[state];
+        auto touch = [&](int key) {
+            if (touched[key]) return;
+            touched[key] = 1;
+            touchedKeys.push_back(key);
+        };
+        for (int i = 0; i < items.size(); ++i) {
+            const Item& item = items[i];
+            if (item.type == ItemType::BACKWARD) continue;
+            int symbol = itemSymbols(item)[item.rawIndex];
+            if (symbol < terminalCount) continue;
+            int production = productionBase[item.key] + item.rawsIndex;
+            int suffix = suffixBase[production] + item.rawIndex + 1;
+            int key = symbol - terminalCount;
+            touch(key);
+            BitMatrix::unite(closureLookaheads.row(key), suffixFirst.row(suffix), words);
+            if (!suffixNullable[suffix]) continue;
+            if (i < kernelSize) BitMatrix::unite(closureLookaheads.row(key), &kernelLookaheads[state][i * words], words);
+            // 初始节点的核心项目同时也是闭包项目
+            if (i >= kernelSize || startItems[production] == item) {
+                touch(item.key);
+                closureEdges[item.key].push_back(key);
+            }
+        }
+        changed = touchedKeys;
+        while (changed.size()) {
+            int cur = changed.back();
+            changed.pop_back();
+            for (int next : closureEdges[cur]) {
+                if (closureLookaheads.unite(next, cur)) changed.push_back(next);
             }
-            // 加入移进关系
-            forwards[cur][raw] = target;
+        }
+        itemLookaheads.assign(items.size() * words, 0);
+        for (int i = 0; i < items.size(); ++i) {
+            const Item& item = items[i];
+            int production = productionBase[item.key] + item.rawsIndex;
+            if (i < kernelSize) BitMatrix::unite(&itemLookaheads[i * words], &kernelLookaheads[state][i * words], words);
+            if ((i >= kernelSize || startItems[production] == item) && touched[item.key]) {
+                BitMatrix::unite(&itemLookaheads[i * words], closureLookaheads.row(item.key), words);
+            }
+        }
+        for (int key : touchedKeys) {
+            touched[key] = 0;
+            closureEdges[key].clear();
+            fill(closureLookaheads.row(key), closureLookaheads.row(key) + words, 0);
+        }
+        touchedKeys.clear();
+    };
+
+    // 当前节点经各符号移进后的核心项目及其来源项目，按符号首次出现的顺序处理
+    vector<int> groupOf(terminalCount + nonterminalCount, -1); // 符号编号 -> 分组下标
+    vector<int> groupSymbols;
+    vector<vector<pair<Item, int> > > groups;
+    vector<Item> kernel;
+    vector<uint64_t> kernelLookahead;
+    for (size_t head = 0; head < prepared.size(); ++head) {
+        int cur = prepared[head];
+        queued[cur] = 0;
+        bool fresh = !processed[cur];
+        if (fresh) {
+            slrReportProgress(progress, SLR_PROGRESS_AUTOMATON, expanded++, dfa.size());
+            extend(cur); // 扩展当前DFA节点(可能右侧项目含有非终结符号)
+        }
+        // 先标记为已处理，转移到自身使向前看集合变大时也会重新处理
+        processed[cur] = 1;
+        lookaheadsOf(cur);
+        groupSymbols.clear();
+        groups.clear();
+        for (int it = 0; it < dfa[cur].size(); ++it) {
+            const Item& item = dfa[cur][it];
+            if (item.type == ItemType::BACKWARD)
+                continue; // 规约项
+            const vector<int>& raw = itemSymbols(item);
+            int symbol = raw[item.rawIndex];
+            Item instance(item.key, item.rawIndex + 1 >= raw.size() ? ItemType::BACKWARD : ItemType::FORWARD,
+                item.rawsIndex, item.rawIndex + 1);
+            if (groupOf[symbol] < 0) {
+                groupOf[symbol] = groups.size();
+                groupSymbols.push_back(symbol);
+                groups.emplace_back();
+            }
+            groups[groupOf[symbol]].push_back(make_pair(instance, it));
+        }
+        for (int group = 0; group < groups.size(); ++group) {
+            int symbol = groupSymbols[group];
+            groupOf[symbol] = -1;
+            // 核心项目排序，向前看集合随项目一起排列
+            auto& moved = groups[group];
+            sort(moved.begin(), moved.end(), [&](const pair<Item, int>& a, const pair<Item, int>& b) {
+                int pa = productionBase[a.first.key] + a.first.rawsIndex, pb = productionBase[b.first.key] + b.first.rawsIndex;
+                return pa != pb ? pa < pb : a.first.rawIndex < b.first.rawIndex;
+            });
+            kernel.clear();
+            kernelLookahead.assign(moved.size() * words, 0);
+            for (int i = 0; i < moved.size(); ++i) {
+                kernel.push_back(moved[i].first);
+                BitMatrix::unite(&kernelLookahead[i * words], &itemLookaheads[moved[i].second * words], words);
+            }
+            size_t actionCell = (size_t)cur * terminalCount + symbol;
+            size_t gotoCell = (size_t)cur * nonterminalCount + symbol - terminalCount;
+            int target;
+            if (!fresh) {
+                // 已处理过的节点沿原有转移传递
+                target = symbol < terminalCount ? SLR_VALUE(actionRows[actionCell]) : gotoRows[gotoCell];
+            }
+            else {
+                target = -1;
+                vector<int>& candidates = isocores[itemSetKey(kernel)];
+                for (int candidate : candidates) {
+                    stats.itemSetComparisons++;
+                    if (weaklyCompatible(kernelLookaheads[candidate], kernelLookahead, kernel.size(), words)) {
+                        target = candidate;
+                        break;
+                    }
+                }
+                if (target == -1) {
+                    // 没有可以合并的同核心节点 -> 新增一个DFA节点，处理到它时再扩展
+                    target = dfa.size();
+                    candidates.push_back(target);
+                    dfa.push_back(kernel);
+                    kernelSizes.push_back(kernel.size());
+                    kernelLookaheads.push_back(kernelLookahead);
+                    processed.push_back(0);
+                    queued.push_back(1);
+                    prepared.push_back(target);
+                    actionRows.resize(dfa.size() * terminalCount, SLR_ERROR);
+                    gotoRows.resize(dfa.size() * nonterminalCount, -1);
+                }
+                else stats.merges++;
+                // 加入移进关系：终结符号移进写入 ACTION 表，非终结符号转移写入 GOTO 表
+                if (symbol < terminalCount) actionRows[actionCell] = SLR_ENTRY(SLR_SHIFT, target);
+                else gotoRows[gotoCell] = target;
+            }
+            // 并上向前看集合，已处理过的节点有新增时重新处理
+            vector<uint64_t>& lookahead = kernelLookaheads[target];
+            if (BitMatrix::unite(lookahead.data(), kernelLookahead.data(), lookahead.size()) && processed[target] && !queued[target]) {
+                queued[target] = 1;
+                prepared.push_back(target);
+            }
+        }
+    }
+
+    // 规约项目的向前看集合，编号同 initReduce
+    size_t reduceCount = 0;
+    for (auto& state : dfa) {
+        for (const Item& item : state) {
+            if (item.type == ItemType::BACKWARD) reduceCount++;
         }
     }
+    lookaheads = BitMatrix(reduceCount, terminalCount);
+    size_t row = 0;
+    for (int state = 0; state < dfa.size(); ++state) {
+        lookaheadsOf(state);
+        for (int i = 0; i < dfa[state].size(); ++i) {
+            if (dfa[state][i].type == ItemType::BACKWARD) BitMatrix::unite(lookaheads.row(row++), &itemLookaheads[i * words], words);
+        }
+    }
+    closures = BitMatrix();
+    stats.cores = isocores.size();
+    stats.states = dfa.size();
+    stats.items = 0;
+    for (auto& state : dfa) stats.items += state.size();
 }
-// 判断是否SLR
-void Grammer::initIsSLR() {
-    // DFA图构建完成后 -> 判断移进规约是否冲突
-    if (isSLR) {
-        stringstream ss;
-        for (int cur = 0; cur < dfa.size(); ++cur) {
-            set<string> curForwards, curBackwards, duplicates;
-            for (auto p : forwards[cur]) {
-                curForwards.insert(p.first);
+/**
+ * 生成LALR(1)规约项目的向前看集合（DeRemer-Pennello），在DFA的非终结符号转移 (p, A) 上：
+ * DR(p, A) 为 goto(p, A) 中能移进的终结符号；goto(p, A) 经可空的 C 转移时 (p, A) reads (goto(p, A), C)；
+ * B -> βAγ 且 γ 可空、p' 经 β 到达 p 时 (p, A) includes (p', B)；A -> ω 从 p 经 ω 到达 q 时，q 中该规约项目 lookback (p, A)
+ * Read 为 DR 并上 reads 关系上的 Read，Follow 为 Read 并上 includes 关系上的 Follow，都用 digraph 按强连通分量求出，
+ * 规约项目的向前看集合为它 lookback 的各转移的 Follow 之并
+ * 初始节点的核心项目不来自任何转移，为它设一个虚拟转移，其 Read 只有结束符
+ */
+void Grammer::initLookahead(const SlrProgress& progress) {
+    int terminalCount = terminals.size();
+    int nonterminalCount = nonterminals.size();
+    int stateCount = dfa.size();
+    // 非终结符号转移的编号，布局同 GOTO 表，-1 为没有转移；同一状态出发的转移编号连续
+    vector<int> transitionOf(gotoRows.size(), -1);
+    vector<pair<int, int> > transitions; // 转移编号 -> (状态, 非终结符号编号)
+    vector<int> transitionBase(stateCount + 1, 0); // 状态 -> 从它出发的第一个转移的编号
+    for (int state = 0; state < stateCount; ++state) {
+        transitionBase[state] = transitions.size();
+        for (int key = 0; key < nonterminalCount; ++key) {
+            size_t cell = (size_t)state * nonterminalCount + key;
+            if (gotoRows[cell] < 0) continue;
+            transitionOf[cell] = transitions.size();
+            transitions.push_back(make_pair(state, key));
+        }
+    }
+    int root = transitions.size();
+    transitionBase[stateCount] = root;
+    transitions.push_back(make_pair(0, startId));
+    stats.transitions = root;
+
+    // DR 和 reads，求出 Read；DR 只取决于目标状态，每个状态只求一次
+    BitMatrix shifts(stateCount, terminalCount); // 状态 -> 能移进的终结符号（不含EPSILON）
+    for (int state = 0; state < stateCount; ++state) {
+        const int32_t* action = actionRows.data() + (size_t)state * terminalCount;
+        for (int terminal = 0; terminal < terminalCount; ++terminal) {
+            if (terminal != epsilonId && SLR_TYPE(action[terminal]) == SLR_SHIFT) shifts.set(state, terminal);
+        }
+    }
+    BitMatrix sets(transitions.size(), terminalCount);
+    vector<vector<int> > edges(transitions.size());
+    for (int x = 0; x < root; ++x) {
+        int target = gotoRows[(size_t)transitions[x].first * nonterminalCount + transitions[x].second];
+        BitMatrix::unite(sets.row(x), shifts.row(target), sets.rowWords());
+        for (int y = transitionBase[target]; y < transitionBase[target + 1]; ++y) {
+            if (nullable[transitions[y].second]) edges[x].push_back(y);
+        }
+    }
+    sets.set(root, endId);
+    digraph(edges, sets);
+    slrReportProgress(progress, SLR_PROGRESS_LOOKAHEAD, 1, 3);
+
+    // 规约项目按状态和项目的顺序编号，与 initReduce 一致
+    vector<int> reduceBase(stateCount + 1, 0); // 状态 -> 其第一个规约项目的编号
+    vector<int> reduceProductions; // 规约项目编号 -> 产生式编号
+    for (int state = 0; state < stateCount; ++state) {
+        reduceBase[state] = reduceProductions.size();
+        for (const Item& item : dfa[state]) {
+            if (item.type == ItemType::BACKWARD) reduceProductions.push_back(productionBase[item.key] + item.rawsIndex);
+        }
+    }
+    reduceBase[stateCount] = reduceProductions.size();
+
+    // 从每个转移的状态出发，沿其非终结符号各产生式的右部前进，得到 includes 和 lookback
+    for (auto& edge : edges) edge.clear();
+    vector<pair<int, int> > lookbacks; // (规约项目编号, 转移编号)
+    for (int x = 0; x <= root; ++x) {
+        int key = transitions[x].second;
+        // 虚拟转移只对应初始节点的核心项目，即起始符号的第一个产生式
+        int last = x == root ? productionBase[key] + 1 : productionBase[key + 1];
+        for (int p = productionBase[key]; p < last; ++p) {
+            const vector<int>& raw = productionSymbols[p];
+            // 右部从 nullableFrom 开始的部分可空
+            int nullableFrom = raw.size();
+            while (nullableFrom > 0) {
+                int symbol = raw[nullableFrom - 1];
+                if (symbol < terminalCount ? symbol != epsilonId : !nullable[symbol - terminalCount]) break;
+                nullableFrom--;
+            }
+            // 与DFA中的项目一致：初始节点的核心项目从第一个符号开始，闭包加入的项目从起始项目开始
+            int offset = x == root ? 0 : startItems[p].type == ItemType::BACKWARD ? raw.size() : startItems[p].rawIndex;
+            int state = transitions[x].first;
+            for (; offset < raw.size(); ++offset) {
+                int symbol = raw[offset];
+                if (symbol < terminalCount) {
+                    state = SLR_VALUE(actionRows[(size_t)state * terminalCount + symbol]);
+                    continue;
+                }
+                size_t cell = (size_t)state * nonterminalCount + symbol - terminalCount;
+                if (offset + 1 >= nullableFrom) edges[transitionOf[cell]].push_back(x);
+                state = gotoRows[cell];
             }
-            for (auto p : backwards[cur]) {
-                curBackwards.insert(p.first);
+            for (int r = reduceBase[state]; r < reduceBase[state + 1]; ++r) {
+                if (reduceProductions[r] == p) lookbacks.push_back(make_pair(r, x));
             }
-            set_intersection(curForwards.begin(), curForwards.end(),
-                curBackwards.begin(), curBackwards.end(),
-                inserter(duplicates, duplicates.begin()));
-            if (!duplicates.empty()) {
-                // 交集不空 不为SLR
+        }
+    }
+    digraph(edges, sets);
+    slrReportProgress(progress, SLR_PROGRESS_LOOKAHEAD, 2, 3);
+
+    lookaheads = BitMatrix(reduceProductions.size(), terminalCount);
+    for (auto& lookback : lookbacks) {
+        BitMatrix::unite(lookaheads.row(lookback.first), sets.row(lookback.second), lookaheads.rowWords());
+    }
+}
+// 按向前看集合写入规约：移进优先，规约之间产生式编号小（在文法中先出现）的优先，与项目在闭包中的顺序无关
+// 同一终结符号上有多个动作时记录冲突，没有写入的动作留给 GLR 分析
+void Grammer::initReduce() {
+    int terminalCount = terminals.size();
+    const char* lookaheadName = mode == SLR_MODE_SLR ? "Follow集合" : "向前看集合";
+    isSLR = true; // 暂时先是
+    vector<int32_t> reduces(terminalCount);
+    int row = 0; // LALR(1)、LR(1) 规约项目编号
+    for (int cur = 0; cur < dfa.size(); ++cur) {
+        reduces.assign(terminalCount, SLR_ERROR);
+        size_t conflictBegin = conflictRows.size();
+        for (const Item& item : dfa[cur]) {
+            if (item.type != ItemType::BACKWARD) continue;
+            int production = productionBase[item.key] + item.rawsIndex;
+            int32_t entry = SLR_ENTRY(item.key == startId ? SLR_ACCEPT : SLR_REDUCE, production);
+            const uint64_t* lookahead = mode == SLR_MODE_SLR ? follow.row(item.key) : lookaheads.row(row++);
+            BitMatrix::forEach(lookahead, follow.rowWords(), [&](size_t el) {
+                if (reduces[el] != SLR_ERROR) {
+                    // 存在交集，分析表有冲突
+                    isSLR = false;
+                    stringstream ss;
+                    ss << "第" << cur << "个节点中规约项目的" << lookaheadName << "有交集\n";
+                    reason += ss.str();
+                    bool earlier = SLR_VALUE(entry) < SLR_VALUE(reduces[el]);
+                    conflictRows.push_back(SlrConflict{ (int32_t)((size_t)cur * terminalCount + el), earlier ? reduces[el] : entry });
+                    if (!earlier) return;
+                }
+                reduces[el] = entry;
+            });
+        }
+        int32_t* action = actionRows.data() + (size_t)cur * terminalCount;
+        for (int terminal = 0; terminal < terminalCount; ++terminal) {
+            if (action[terminal] == SLR_ERROR) action[terminal] = reduces[terminal];
+            else if (reduces[terminal] != SLR_ERROR) {
+                // 移进和规约冲突，按移进处理
                 isSLR = false;
-                ss.str("");
-                ss.clear();
-                ss << "第" << cur
-                    << "个节点的移进项First集合和规约项Follow集合有交集\n";
+                stringstream ss;
+                ss << "第" << cur << "个节点中移进项目和规约项目的" << lookaheadName << "有交集\n";
                 reason += ss.str();
+                conflictRows.push_back(SlrConflict{ (int32_t)((size_t)cur * terminalCount + terminal), reduces[terminal] });
             }
         }
+        // 同一状态的冲突按终结符号排列，同一表项中按产生式编号排列
+        sort(conflictRows.begin() + conflictBegin, conflictRows.end(), [](const SlrConflict& a, const SlrConflict& b) {
+            return a.cell != b.cell ? a.cell < b.cell : SLR_VALUE(a.action) < SLR_VALUE(b.action);
+        });
     }
+    lookaheads = BitMatrix();
 }
-// 获取当前节点是否在当前DFA结点列表中
-int Grammer::findState(vector<Item>& current) {
-    for (int i = 0; i < dfa.size(); ++i) {
-        auto& state = dfa[i];
-        // if (current.size() < state.size()) continue;
-        bool exist = true;
-        // 拿个map存state加快查询速度
-        unordered_map<string, int> stateMap;
-        for (int j = 0; j < state.size(); ++j) {
-            stateMap[state[j].id()] = j;
+// 生成分析表：ACTION、GOTO 表已在生成DFA和写入规约时填好（移进优先于规约），这里补上产生式和语义动作
+void Grammer::initTable() {
+    SlrStageTimer timer(&stats.table);
+    // 分析表数据
+    struct Storage {
+        vector<int32_t> action;
+        vector<int32_t> gotos;
+        vector<SlrProduction> productions;
+        vector<SlrTreeAction> tree;
+        vector<SlrConflict> conflicts;
+    };
+    shared_ptr<Storage> storage = make_shared<Storage>();
+    table.stateCount = dfa.size();
+    table.terminalCount = terminals.size();
+    table.nonterminalCount = nonterminals.size();
+    table.productionCount = productions.size();
+
+    // 产生式和语义动作
+    for (int i = 0; i < productions.size(); ++i) {
+        const string& key = productions[i].first;
+        int rawsIndex = productions[i].second;
+        SlrProduction production;
+        production.key = nonterminalIds[key];
+        production.length = 0;
+        for (int symbol : productionSymbols[i]) {
+            if (symbol != epsilonId) production.length++;
         }
-        for (auto& node : current) {
-            if (!stateMap.count(node.id())) {
-                exist = false;
-                break;
+        production.treeBegin = storage->tree.size();
+        if (rawsIndex < actions[key].size()) {
+            map<int, int>& action = actions[key][rawsIndex];
+            for (auto it = action.rbegin(); it != action.rend(); ++it) {
+                if (it->first < 0 || it->first >= production.length || it->second < -1) continue;
+                storage->tree.push_back(SlrTreeAction{ it->first, it->second });
             }
         }
-        if (exist) return i;
+        production.treeEnd = storage->tree.size();
+        storage->productions.push_back(production);
     }
-    return -1;
+    table.treeCount = storage->tree.size();
+
+    storage->action.swap(actionRows);
+    storage->gotos.swap(gotoRows);
+    storage->conflicts.swap(conflictRows);
+    table.conflictCount = storage->conflicts.size();
+
+    table.action = storage->action.data();
+    table.gotos = storage->gotos.data();
+    table.productions = storage->productions.data();
+    table.tree = storage->tree.data();
+    table.conflicts = storage->conflicts.data();
+    table.storage = storage;
+}
+// 获取核心项目相同的DFA节点
+int Grammer::findState(const vector<Item>& kernel) {
+    stats.itemSetComparisons++;
+    auto it = states.find(itemSetKey(kernel));
+    return it == states.end() ? -1 : it->second;
+}
+
+// 获取核心项目的签名
+ItemSetKey Grammer::itemSetKey(const vector<Item>& kernel) const {
+    ItemSetKey key;
+    key.reserve(kernel.size());
+    for (const Item& item : kernel) {
+        // 项目类型由推导式内编号决定，不必打包
+        uint64_t production = productionBase[item.key] + item.rawsIndex;
+        key.push_back(production << 32 | (uint32_t)item.rawIndex);
+    }
+    sort(key.begin(), key.end());
+    return key;
+}
+
+// 获取符号编号：终结符号为其编号，非终结符号为终结符号数 + 其编号
+int Grammer::symbolId(const string& name) const {
+    int id = terminalId(name);
+    if (id >= 0) return id;
+    id = nonterminalId(name);
+    return id < 0 ? -1 : (int)terminals.size() + id;
+}
+
+// 获取项目所在产生式的右部符号编号
+const vector<int>& Grammer::itemSymbols(const Item& item) const {
+    return productionSymbols[productionBase[item.key] + item.rawsIndex];
 }
 
 // 是否SLR
 bool Grammer::slr() { return isSLR; }
+
+SlrTableMode Grammer::getMode() const { return mode; }
 // 是否有语法错误
 bool Grammer::bad() { return !error.empty(); }
 // 获取不是SLR的原因
@@ -456,7 +1125,7 @@ set<string> Grammer::getNotEnd() { return notEnd; }
 // 获取终结symbols集合
 set<string> Grammer::getEnd() { return endSet; }
 // 获取文法起始symbols
-string Grammer::getStart() {
+string Grammer::getStart() const {
     return start;
 }
 // 获取拓广文法
@@ -486,179 +1155,402 @@ string Grammer::getExtraGrammer() {
     return ss.str();
 }
 // 获取生成的DFA
-vector<vector<Item>> Grammer::getDfa() { return dfa; }
+const vector<vector<Item>>& Grammer::getDfa() {
+    analyze();
+    return dfa;
+}
+// 提前生成First、Follow集合和DFA
+void Grammer::prepare(const SlrProgress& progress) {
+    analyze(progress);
+}
 // 获取解析后的文法
-map<string, vector<vector<string>>> Grammer::getFormula() {
+const map<string, vector<vector<string>>>& Grammer::getFormula() const {
     return formula;
 }
 
+// 获取终结符号编号，不存在时返回-1
+int Grammer::terminalId(const string& name) const {
+    auto it = terminalIds.find(name);
+    return it == terminalIds.end() ? -1 : it->second;
+}
+
+// 获取终结符号名称
+const string& Grammer::terminalName(int id) const {
+    return terminals[id];
+}
+
+// 终结符号（含结束符）数量
+int Grammer::terminalCount() const {
+    return terminals.size();
+}
+
+// 获取非终结符号编号，不存在时返回-1
+int Grammer::nonterminalId(const string& name) const {
+    auto it = nonterminalIds.find(name);
+    return it == nonterminalIds.end() ? -1 : it->second;
+}
+
+// 获取非终结符号名称
+const string& Grammer::nonterminalName(int id) const {
+    return nonterminals[id];
+}
+
+// 获取产生式左部
+const string& Grammer::productionKey(int id) const {
+    return productions[id].first;
+}
+
+// 获取产生式右部
+const vector<string>& Grammer::productionRaws(int id) const {
+    return formula.at(productions[id].first)[productions[id].second];
+}
+
+// 分析表是否来自缓存
+bool Grammer::fromCache() const {
+    return cached;
+}
+
+// 获取分析表
+const SlrTable& Grammer::getTable() const {
+    return table;
+}
+
+// 获取各阶段耗时和计数
+const SlrStats& Grammer::getStats() const {
+    return stats;
+}
+
 // 拿到移进目标
 int Grammer::forward(int state, string key) {
-    if (forwards[state].count(key)) {
-        return forwards[state][key];
-    }
-    return -1;
+    int symbol = symbolId(key);
+    if (!table.action || state < 0 || state >= table.stateCount || symbol < 0) return -1;
+    if (symbol >= table.terminalCount) return table.gotoOf(state, symbol - table.terminalCount);
+    int32_t entry = table.actionOf(state, symbol);
+    return SLR_TYPE(entry) == SLR_SHIFT ? SLR_VALUE(entry) : -1;
 }
 
 // 拿到规约目标
 int Grammer::backward(int state, string key) {
-    if (backwards[state].count(key)) {
-        return backwards[state][key];
-    }
-    return -1;
+    int terminal = terminalId(key);
+    if (!table.action || state < 0 || state >= table.stateCount || terminal < 0) return -1;
+    int32_t entry = table.actionOf(state, terminal);
+    return SLR_TYPE(entry) == SLR_REDUCE || SLR_TYPE(entry) == SLR_ACCEPT ? SLR_VALUE(entry) : -1;
 }
-// 根据lex输入和已生成的SLR来解析生成语法树
-ParsedResult Grammer::parse(string input) {
-    // input 是lex文件 LABEL : VALUE
-    queue<pair<string, string>> lex;
-    string label;
-    string value;
-    bool isLabel = true;
-    for (char c : input) {
-        if (c == ' ') {
-            continue;
-        }
-        if (c == '\n') {
-            if (label.size() && label != "COMMENT" && label != "comment") {
-                lex.push({ label, value });
+// 按产生式和语义动作规约语法树节点
+bool Grammer::reduceTree(int id, vector<TreeNode*>& workspace, string& error) const {
+    const SlrProduction& production = table.productions[id];
+    // 生成语法树节点
+    TreeNode* created = new TreeNode;
+    TreeNode* current = created;
+    current->label = nonterminals[production.key];
+    int offset = workspace.size() - production.length;
+    if (offset < 0) {
+        delete created;
+        error = "语法树解析错误，缺少节点";
+        return false;
+    }
+    // 语义动作已按右部下标从大到小排列
+    for (int i = production.treeBegin; i < production.treeEnd; ++i) {
+        int index = table.tree[i].index;
+        int value = table.tree[i].value;
+        if (value == -1) {
+            // 作为树根
+            if (workspace[index + offset]->children.size() > 0 && current->children.size() > 0) {
+                delete created;
+                error = "语法树解析错误，根节点冲突";
+                return false;
             }
-            label.clear();
-            value.clear();
-            isLabel = true;
-            continue;
-        }
-        if (c == ':' && isLabel) {
-            isLabel = false;
+            if (workspace[index + offset]->children.size() == 0) {
+                workspace[index + offset]->children = current->children;
+            }
+            current = workspace[index + offset];
             continue;
         }
-        if (isLabel) {
-            label += c;
-        }
-        else {
-            value += c;
+        TreeNode* child = workspace[index + offset];
+        if (value >= current->children.size()) {
+            // 扩容
+            current->children.resize(value + 1);
         }
+        current->children[value] = child;
     }
-    if (label.size() && !isLabel && label != "COMMENT" && label != "comment") {
-        lex.push({ label, value });
+    // 新建的节点被右部的节点取代
+    if (current != created) delete created;
+    // 没有被语义动作引用的右部节点不会出现在语法树中，直接释放
+    for (int i = offset; i < (int)workspace.size(); ++i) {
+        TreeNode* node = workspace[i];
+        if (node == current || count(current->children.begin(), current->children.end(), node)) continue;
+        freeTree(node);
     }
+    // 出栈
+    workspace.erase(workspace.begin() + offset, workspace.end());
+    // 将新生成的节点入栈
+    workspace.push_back(current);
+    return true;
+}
+namespace {
+    // LEX文件（每行 LABEL : VALUE）的记号流，VALUE 为去掉首尾空格后的区间
+    class LexTextStream : public TokenStream {
+    private:
+        Grammer& grammer;
+        const string& input;
+        size_t pos = 0;
+
+        static bool isComment(const string& label) {
+            return label == "COMMENT" || label == "comment";
+        }
+
+    public:
+        LexTextStream(Grammer& grammer, const string& input) : grammer(grammer), input(input) {}
+
+        bool next(InputToken& token) override {
+            while (pos < input.size()) {
+                size_t lineEnd = input.find('\n', pos);
+                bool terminated = lineEnd != string::npos;
+                if (!terminated) lineEnd = input.size();
+                size_t colon = input.find(':', pos);
+                if (colon > lineEnd) colon = string::npos;
+                size_t from = pos;
+                pos = terminated ? lineEnd + 1 : lineEnd;
+                // 最后一行没有换行时必须包含 ':'
+                if (!terminated && colon == string::npos) continue;
+
+                // 去掉空格后的 LABEL
+                string label;
+                size_t labelEnd = colon == string::npos ? lineEnd : colon;
+                for (size_t i = from; i < labelEnd; ++i) {
+                    if (input[i] != ' ' && input[i] != '\r') label += input[i];
+                }
+                if (label.empty() || isComment(label)) continue;
+
+                // VALUE 区间
+                size_t begin = colon == string::npos ? lineEnd : colon + 1;
+                size_t end = lineEnd;
+                while (begin < end && (input[begin] == ' ' || input[begin] == '\r')) begin++;
+                while (end > begin && (input[end - 1] == ' ' || input[end - 1] == '\r')) end--;
+
+                token.terminal = grammer.terminalId(label);
+                if (token.terminal < 0) {
+                    // 未知的 LABEL：区间指向 LABEL 本身，便于报错
+                    begin = from;
+                    while (input[begin] == ' ') begin++;
+                    end = begin + label.size();
+                }
+                token.begin = begin;
+                token.end = end;
+                return true;
+            }
+            return false;
+        }
+    };
+}
+
+// 根据lex输入和已生成的SLR来解析生成语法树
+ParsedResult Grammer::parse(string input, const SlrProgress& progress, bool trace) {
+    // input 是lex文件 LABEL : VALUE
+    LexTextStream tokens(*this, input);
+    return parse(tokens, input, progress, trace);
+}
+
+// 根据lex输入按 GLR 分析，记号流的解析见 glrparse.cpp
+ParsedResult Grammer::parseGlr(string input, const SlrProgress& progress) {
+    LexTextStream tokens(*this, input);
+    return parseGlr(tokens, input, progress);
+}
+
+// 根据记号流和分析表来解析生成语法树，source 为记号区间所指的源文本
+ParsedResult Grammer::parse(TokenStream& tokens, const string& source, const SlrProgress& progress, bool trace) {
+    SlrStageTimer timer(&stats.parse);
     ParsedResult result;
-    string output;
+    if (trace) result.trace = ParseTrace(this);
     vector<int> stash;
-    // 在工作区的TreeNode
+    // 在工作区的TreeNode，出错或取消提前返回时统一释放
     vector<TreeNode*> workspace;
-    lex.push({ END_FLAG, END_FLAG });
+    struct WorkspaceGuard {
+        vector<TreeNode*>& nodes;
+        ~WorkspaceGuard() {
+            if (nodes.empty()) return;
+            TreeNode* holder = new TreeNode;
+            holder->children.swap(nodes);
+            freeTree(holder);
+        }
+    } guard{ workspace };
+    // 当前输入的记号，读完后为结束符
+    InputToken lookahead;
+    size_t consumed = 0; // 已读取的记号数，每读取一批汇报一次进度
+    auto advance = [&]() {
+        if (tokens.next(lookahead)) {
+            if (progress && ++consumed % 1024 == 0) {
+                slrReportProgress(progress, SLR_PROGRESS_PARSE, lookahead.end, source.size());
+            }
+            return true;
+        }
+        result.error = tokens.getError();
+        lookahead = InputToken{ endId, source.size(), source.size() };
+        slrReportProgress(progress, SLR_PROGRESS_PARSE, source.size(), source.size());
+        return result.error.empty();
+    };
+    if (bad() || !table.action) {
+        result.error = "文法有误，无法解析";
+        return result;
+    }
+    if (!advance()) return result;
     int state = 0; // 当前DFA状态编号
-    int count = 0;
     stringstream ss;
+    // 上次移进以来规约转移到的 (栈下标, 状态)，下标不减；栈不低于该下标时同一状态再次出现说明分析格局重复
+    vector<pair<size_t, int> > gotos;
+    size_t lowest = 0; // 上次移进以来栈的最低高度，此后入栈的状态都在它之上
     for (;;) {
-        ss.str("");
-        ss.clear();
-        map<string, int>& curForwards = forwards[state]; // 当前所有可移进状态
-        map<string, int>& curBackwards = backwards[state]; // 当前所有可规约状态
-
-        auto pair = lex.front(); // 当前输入的字符
-        string token = pair.first;
-        string value = pair.second;
         stash.push_back(state); // 当前状态入栈
+        int32_t entry = lookahead.terminal >= 0 ? table.actionOf(state, lookahead.terminal) : SLR_ERROR;
 
-        if (curForwards.count(token)) {
+        if (SLR_TYPE(entry) == SLR_SHIFT) {
             // 找到了移进关系
-            lex.pop();
-            ++count;
-            int next = curForwards[token]; // 下一个状态
-            ss << "在状态" << state << "通过" << token << "移进到状态" << next;
+            result.shifts++;
+            stats.shifts++;
+            int next = SLR_VALUE(entry); // 下一个状态
+            if (trace) result.trace.push(ParseEvent{ state, entry, lookahead.terminal, next });
             state = next;
-            output += token;
-            result.outputs.push_back(output);
+            gotos.clear();
+            lowest = stash.size();
             TreeNode* current = new TreeNode;
-            current->label = token;
-            current->value = value;
+            current->label = terminals[lookahead.terminal];
+            current->value = source.substr(lookahead.begin, lookahead.end - lookahead.begin);
             workspace.push_back(current);
-            result.routes.push_back(ss.str());
+            if (!advance()) return result;
             continue;
         }
-        if (curBackwards.count(token)) {
+        if (SLR_TYPE(entry) != SLR_ERROR) {
             // 找到了规约关系
-            int target = curBackwards[token];
-            ss << "在状态" << state << "通过" << token << "规约到状态" << target;
-            Item& item = dfa[state][target];
-            vector<string>& raws = formula[item.key][item.rawsIndex];
-            vector<string> rawsCopy;
-            for (auto& el : raws) {
-                if (el != EPSILON) {
-                    rawsCopy.push_back(el);
-                }
-            }
-            // 生成语法树节点
-            map<int, int> action = actions[item.key][item.rawsIndex];
-            result.routes.push_back(ss.str());
-            TreeNode* current = new TreeNode;
-            current->label = item.key;
-            int offset = workspace.size() - rawsCopy.size();
-            if (offset < 0) {
-                result.error = "语法树解析错误，缺少节点";
-                return result;
-            }
-            for (int i = 0; i < rawsCopy.size(); i++) {
-                int index = rawsCopy.size() - 1 - i;
-                if (!action.count(index) || action[index] < -1) {
-                    continue;
-                }
-                if (action[index] == -1) {
-                    // 作为树根
-                    if (workspace[index + offset]->children.size() > 0 && current->children.size() > 0) {
-                        result.error = "语法树解析错误，根节点冲突";
-                        return result;
-                    }
-                    if (workspace[index + offset]->children.size() == 0) {
-                        workspace[index + offset]->children = current->children;
-                    }
-                    current = workspace[index + offset];
-                    continue;
-                }
-                TreeNode* child = workspace[index + offset];
-                if (action[index] >= current->children.size()) {
-                    // 扩容
-                    current->children.resize(action[index] + 1);
-                }
-                current->children[action[index]] = child;
-            }
-            // 出栈
-            workspace.erase(workspace.begin() + offset, workspace.end());
-            // 将新生成的节点入栈
-            workspace.push_back(current);
+            result.reductions++;
+            stats.reductions++;
+            const SlrProduction& production = table.productions[SLR_VALUE(entry)];
+            const string& key = nonterminals[production.key];
+            if (!reduceTree(SLR_VALUE(entry), workspace, result.error)) return result;
 
-            if (item.key == start) {
+            if (SLR_TYPE(entry) == SLR_ACCEPT) {
                 // 接收
+                if (trace) result.trace.push(ParseEvent{ state, entry, lookahead.terminal, -1 });
                 result.accept = true;
-                result.outputs.push_back(start);
                 break;
             }
-            int useful = 0;
-            for (int i = 0; i < raws.size(); ++i) {
-                // 找到不是EPSILON的大小
-                if (raws[i] != EPSILON) useful++;
-            }
+            int useful = production.length;
             if (useful > 0) {
-                output.erase(output.end() - useful, output.end());
                 stash.erase(stash.end() - useful, stash.end());
             }
-            int next = forwards[stash[stash.size() - 1]][item.key];
+            int next = table.gotoOf(stash.back(), production.key);
+            if (next < 0) {
+                ss << "在状态" << stash.back() << "上找不到" << key << "对应的转移";
+                result.error = ss.str();
+                break;
+            }
+            if (trace) result.trace.push(ParseEvent{ state, entry, lookahead.terminal, next });
             state = next;
-            output += item.key;
-            result.outputs.push_back(output);
+            // 不读入记号的规约只由栈顶以上的部分决定：next 在同一下标上再次入栈（其下不变），
+            // 或与上次移进后入栈、仍在栈中的状态相同（其上的规约会无限重复），分析都不会结束
+            size_t top = stash.size();
+            lowest = min(lowest, top);
+            while (gotos.size() && gotos.back().first > top) gotos.pop_back();
+            bool repeated = find(stash.begin() + lowest, stash.end(), next) != stash.end();
+            for (auto it = gotos.rbegin(); !repeated && it != gotos.rend() && it->first == top; ++it) {
+                repeated = it->second == next;
+            }
+            if (repeated) {
+                ss << "在" << terminals[lookahead.terminal] << "前的规约在状态" << next << "上陷入循环，分析表有冲突时可改用 GLR 分析";
+                result.error = ss.str();
+                break;
+            }
+            gotos.push_back(make_pair(top, next));
             continue;
         }
-        // 找不到关系，出错
+        // 找不到关系，出错，未知的记号用其源文本报错
+        string token = lookahead.terminal >= 0
+            ? terminals[lookahead.terminal]
+            : source.substr(lookahead.begin, lookahead.end - lookahead.begin);
         ss << "在状态" << state << "上找不到" << token << "对应的移进/规约关系";
         result.error = ss.str();
         break;
     }
+    if (!result.accept) {
+        return result;
+    }
     if (workspace.size() != 1) {
-        error = "语法树解析错误，规约树不唯一";
+        result.error = "语法树解析错误，规约树不唯一";
         return result;
     }
     result.root = workspace[0];
     workspace.pop_back();
     return result;
 }
+
+// 解析过程每隔多少步保存一次分析栈，读取符号串时最多重放这么多步
+static const size_t CHECKPOINT = 1024;
+
+// 第 i 步的说明
+string ParseTrace::route(size_t i) const {
+    const ParseEvent& event = events[i];
+    const SlrTable& table = grammer->getTable();
+    stringstream ss;
+    ss << "在状态" << event.state << "通过" << grammer->terminalName(event.terminal);
+    if (SLR_TYPE(event.action) == SLR_SHIFT) {
+        ss << "移进到状态" << event.target;
+    }
+    else if (SLR_TYPE(event.action) == SLR_ACCEPT) {
+        ss << "规约到" << grammer->nonterminalName(table.productions[SLR_VALUE(event.action)].key) << "，接受";
+    }
+    else {
+        ss << "规约到状态" << event.target;
+    }
+    return ss.str();
+}
+
+// 按一步动作更新分析栈符号
+void ParseTrace::replay(vector<int32_t>& stack, const ParseEvent& event) const {
+    const SlrTable& table = grammer->getTable();
+    if (SLR_TYPE(event.action) == SLR_SHIFT) {
+        stack.push_back(event.terminal);
+        return;
+    }
+    const SlrProduction& production = table.productions[SLR_VALUE(event.action)];
+    stack.resize(stack.size() >= (size_t)production.length ? stack.size() - production.length : 0);
+    stack.push_back(table.terminalCount + production.key);
+}
+
+// 第 i 步后的符号串
+string ParseTrace::output(size_t i) const {
+    const ParseEvent& event = events[i];
+    if (SLR_TYPE(event.action) == SLR_ACCEPT) return grammer->getStart();
+    if (checkpoints.empty()) {
+        vector<int32_t> stack;
+        for (size_t step = 0; step < events.size(); ++step) {
+            if (step % CHECKPOINT == 0) checkpoints.push_back(stack);
+            replay(stack, events[step]);
+        }
+    }
+    vector<int32_t> stack = checkpoints[i / CHECKPOINT];
+    for (size_t step = i / CHECKPOINT * CHECKPOINT; step <= i; ++step) {
+        replay(stack, events[step]);
+    }
+    int terminalCount = grammer->getTable().terminalCount;
+    string result;
+    for (int32_t symbol : stack) {
+        if (result.size()) result += ' ';
+        result += symbol < terminalCount ? grammer->terminalName(symbol) : grammer->nonterminalName(symbol - terminalCount);
+    }
+    return result;
+}
+
+// 释放语法树（语义动作可能让同一节点被引用多次，需去重）
+void freeTree(TreeNode* root) {
+    set<TreeNode*> visited;
+    vector<TreeNode*> prepared;
+    if (root) prepared.push_back(root);
+    while (prepared.size()) {
+        TreeNode* cur = prepared.back();
+        prepared.pop_back();
+        if (!visited.insert(cur).second) continue;
+        for (TreeNode* child : cur->children) {
+            if (child) prepared.push_back(child);
+        }
+    }
+    for (TreeNode* node : visited) delete node;
+}
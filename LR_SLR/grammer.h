@@ -1,17 +1,26 @@
 /*
  * @Author: 20212131001 翁行
  * @Date: 2023-12-16 20:16:38
- * @LastEditTime: 2024-05-25 00:21:04
+ * @LastEditTime: 2026-10-19 23:58:44
  * @FilePath: /LR_SLR/grammer.h
  * @Description: 文法解析、DFA生成、语法树生成 ALL in one
  * Copyright (c) 2024 by wengx00, All Rights Reserved.
  *
  * 版本历史详见.cpp文件
  */
+#ifndef GRAMMER_H
+#define GRAMMER_H
+
 #include <vector>
 #include <set>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "bitmatrix.h"
+#include "slrtable.h"
+#include "slrstats.h"
+#include "slrprogress.h"
 
  // 空符号
 #define EPSILON "EPSILON"
@@ -25,20 +34,26 @@ enum ItemType {
 
 // DFA节点项目
 struct Item {
-    std::string key; // 所属非终结符号
+    int key; // 所属非终结符号编号
     ItemType type; // 递进还是规约
     int rawsIndex; // 推导式编号
     int rawIndex; // 推导式内编号
 
-    Item(std::string key, ItemType type, int rawsIndex, int rawIndex) : key(key), type(type), rawsIndex(rawsIndex), rawIndex(rawIndex) {}
+    Item(int key, ItemType type, int rawsIndex, int rawIndex) : key(key), type(type), rawsIndex(rawsIndex), rawIndex(rawIndex) {}
 
     bool operator==(const Item& node) const {
         return node.key == key && node.type == type && node.rawsIndex == rawsIndex && node.rawIndex == rawIndex;
     }
+};
+
+// 项目集的签名：核心项目按 (产生式编号, 推导式内编号) 打包后升序排列，相同签名的项目集相同
+typedef std::vector<uint64_t> ItemSetKey;
 
-    // 获取唯一标识
-    std::string id() {
-        return key + std::to_string(type) + std::to_string(rawsIndex) + std::to_string(rawIndex);
+struct ItemSetKeyHash {
+    size_t operator()(const ItemSetKey& key) const {
+        uint64_t hash = 1469598103934665603ULL;
+        for (uint64_t item : key) hash = (hash ^ item) * 1099511628211ULL;
+        return (size_t)hash;
     }
 };
 
@@ -53,12 +68,67 @@ public:
     std::string value;
 };
 
+// 输入记号：终结符号编号（Grammer::terminalId，未知为-1）和源文本区间 [begin, end)
+struct InputToken {
+    int terminal = -1;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// 记号流，parse 逐个读取记号
+class TokenStream {
+public:
+    virtual ~TokenStream() {}
+    // 读取下一个记号，没有更多记号或出错时返回false
+    virtual bool next(InputToken&) = 0;
+    // 读取过程中的错误信息，空则无出错
+    virtual std::string getError() { return ""; }
+};
+
+class Grammer;
+
+// 解析过程中的一步：移进、规约或接受
+struct ParseEvent {
+    int32_t state; // 动作前的状态
+    int32_t action; // 分析表中的动作，编码同 SlrTable::action
+    int32_t terminal; // 当前输入的终结符号编号
+    int32_t target; // 动作后的状态，接受时为-1
+};
+
+// 解析过程记录：每步只记录一个 ParseEvent，说明文字和符号串在读取时才生成
+// 引用生成它的文法，文法释放后不能再读取
+class ParseTrace {
+public:
+    ParseTrace() {}
+    explicit ParseTrace(const Grammer* grammer) : grammer(grammer) {}
+
+    size_t size() const { return events.size(); }
+    bool empty() const { return events.empty(); }
+    const ParseEvent& operator[](size_t i) const { return events[i]; }
+    void push(const ParseEvent& event) { events.push_back(event); }
+
+    // 第 i 步的说明，如“在状态0通过id移进到状态5”
+    std::string route(size_t i) const;
+    // 第 i 步后的符号串（分析栈中的符号，空格分隔），接受时为起始符号
+    // 从最近的检查点重放，首次调用时生成检查点，不能在多个线程上同时调用
+    std::string output(size_t i) const;
+
+private:
+    const Grammer* grammer = nullptr;
+    std::vector<ParseEvent> events;
+    mutable std::vector<std::vector<int32_t> > checkpoints; // 每 CHECKPOINT 步之前的分析栈符号
+
+    // 按 event 更新分析栈符号：终结符号为其编号，非终结符号为 terminalCount + 编号
+    void replay(std::vector<int32_t>& stack, const ParseEvent& event) const;
+};
+
 // 句子分析结果
 struct ParsedResult {
-    std::vector<std::string> outputs;
-    // std::vector<std::string> inputs;
-    std::vector<std::string> routes;
-    TreeNode* root; // 语法树
+    ParseTrace trace; // 解析过程，只在 parse 开启记录时才有
+    TreeNode* root = nullptr; // 语法树
+    size_t shifts = 0; // 移进次数
+    size_t reductions = 0; // 规约次数（含接受时的规约）
+    size_t ambiguities = 0; // GLR 分析中语法树所在的分析森林里有多种推导的节点数，语法树只取其中最先得到的推导
 
     bool accept = false; // 是否接受
     std::string error = ""; // 错误信息，空则无出错
@@ -67,46 +137,103 @@ struct ParsedResult {
 // BNF 文法类
 class Grammer {
 private:
-    std::map<std::string, std::vector<std::vector<std::string> > > formula; // 分式
+    std::map<std::string, std::vector<std::vector<std::string> > > formula; // 分式，只用于显示和编号
     std::map<std::string, std::vector<std::map<int, int> > > actions; // 语义动作
     std::string start; // 起始
-    std::map<std::string, std::set<std::string> > first; // FIRST集合元素
-    std::map<std::string, std::set<std::string> > follow; // FOLLOW集合元素
+    int startId = -1; // 起始符号的非终结符号编号
+    BitMatrix first; // 非终结符号编号 -> FIRST集合中的终结符号编号（不含EPSILON）
+    std::vector<char> nullable; // 非终结符号编号 -> FIRST集合是否含EPSILON
+    BitMatrix follow; // 非终结符号编号 -> FOLLOW集合中的终结符号编号
     std::set<std::string> notEnd; // 非终结符号集合
     std::set<std::string> endSet; // 终结符号集合
     std::string error; // 是否有错误
-    std::string reason; // 为什么不是SLR
-    bool isSLR = false; // 是否SLR(1)
+    std::string reason; // 分析表为什么有冲突
+    bool isSLR = false; // 分析表是否无冲突（按所选的构造方法）
+    SlrTableMode mode = SLR_MODE_SLR; // 分析表的构造方法
 
-    std::vector<std::vector<Item> > dfa; // DFA图
-    std::map<int, std::map<std::string, int> > forwards; // 移进关系
-    std::map<int, std::map<std::string, int> > backwards; // 规约关系
+    std::vector<std::vector<Item> > dfa; // DFA图，每个状态先是核心项目，扩展后接着闭包项目
+    std::unordered_map<ItemSetKey, int, ItemSetKeyHash> states; // 核心项目签名 -> 状态编号，只在生成DFA时使用
+    std::vector<Item> startItems; // 产生式编号 -> 该产生式因闭包加入项目集时的项目
+    BitMatrix closures; // 非终结符号编号 -> 它位于点后时闭包加入的产生式集合，只在生成DFA时使用
+    std::vector<int32_t> actionRows; // 生成DFA时逐状态写入的 ACTION 表，布局同 SlrTable::action，生成分析表时移入 table
+    std::vector<int32_t> gotoRows; // 生成DFA时逐状态写入的 GOTO 表，布局同 SlrTable::gotos
+    std::vector<SlrConflict> conflictRows; // 写入规约时被覆盖的动作，布局同 SlrTable::conflicts
+    BitMatrix lookaheads; // LALR(1)、LR(1) 中规约项目 -> 向前看集合，按状态和项目的顺序编号，只在生成分析表时使用
+    std::vector<std::string> terminals; // 终结符号（含结束符），下标为其编号
+    std::map<std::string, int> terminalIds; // 终结符号 -> 编号
+    int endId = -1; // 结束符编号
+    int epsilonId = -1; // EPSILON 的终结符号编号，文法中没有 EPSILON 时为-1
+    std::vector<std::string> nonterminals; // 非终结符号，下标为其编号
+    std::map<std::string, int> nonterminalIds; // 非终结符号 -> 编号
+    std::vector<std::pair<std::string, int> > productions; // 产生式编号 -> (所属非终结符号, 推导式编号)
+    // 分析只使用以下编号后的文法，符号编号：终结符号为其编号，非终结符号为终结符号数 + 其编号
+    std::vector<std::vector<int> > productionSymbols; // 产生式编号 -> 右部符号编号
+    std::vector<int> productionBase; // 非终结符号编号 -> 其第一个产生式的编号，末尾多一项为产生式总数
+    SlrTable table; // 分析表，parse 只读取该表
+    bool analyzed = false; // 是否已生成First、Follow集合和DFA
+    bool cached = false; // 分析表是否来自缓存
+    SlrStats stats; // 各阶段耗时和计数
 
 
+    void initNullable(); // 求出能推导出空串的非终结符号
     void initFirst(); // 生成First集合
     void initFollow(); // 生成Follow集合
+    void initClosure(); // 生成各非终结符号的闭包
     void extend(std::vector<Item>&); // 扩展DFA某节点的推导式
     void extend(int); // 扩展DFA某节点的推导式
-    void initRelation(); // 生成DFA图、规约关系
-    void initIsSLR(); // 初始化是否SLR(1)
-    int findState(std::vector<Item>&); // 是否包含此DFA节点
+    void initRelation(const SlrProgress&); // 生成DFA图和 ACTION、GOTO 表中的移进和转移
+    void initLr1Relation(const SlrProgress&); // 生成合并了弱相容状态的LR(1) DFA、移进和转移，以及规约项目的向前看集合
+    void initLookahead(const SlrProgress&); // 生成LALR(1)规约项目的向前看集合
+    void initReduce(); // 按向前看集合写入 ACTION 表中的规约
+    void initTable(); // 补上产生式和语义动作，生成分析表
+    void analyze(const SlrProgress& progress = nullptr); // 生成First、Follow集合和DFA，命中缓存时在首次访问时才调用
+    int findState(const std::vector<Item>&); // 核心项目相同的DFA节点，不存在时返回-1
+    ItemSetKey itemSetKey(const std::vector<Item>&) const; // 核心项目的签名
+    int symbolId(const std::string&) const; // 符号编号，不存在时返回-1
+    const std::vector<int>& itemSymbols(const Item&) const; // 项目所在产生式的右部符号编号
+    // 按产生式规约 workspace 末尾的右部节点，按语义动作生成节点后放回末尾，出错时返回false并写入error
+    bool reduceTree(int production, std::vector<TreeNode*>& workspace, std::string& error) const;
 public:
-    Grammer(std::string);
+    // cacheDir 非空时先按文法文本哈希查找分析表，命中则跳过First、Follow和DFA的生成，未命中则生成后写入缓存
+    // progress 要求取消时抛出 SlrCancelled；mode 为分析表的构造方法
+    Grammer(std::string, const std::string& cacheDir = "", const SlrProgress& progress = nullptr, SlrTableMode mode = SLR_MODE_SLR);
 
     std::set<std::string> getFirst(std::string); // 获取节点的First集合
     std::set<std::string> getFollow(std::string); // 获取节点的Follow集合
     std::set<std::string> getNotEnd(); // 获取非终结符号集
     std::set<std::string> getEnd(); // 获取终结符号集
     std::string getExtraGrammer(); // 获取拓广文法
-    std::map<std::string, std::vector<std::vector<std::string> > > getFormula(); // 获取分式
-    bool slr();
+    const std::map<std::string, std::vector<std::vector<std::string> > >& getFormula() const; // 获取分式
+    bool slr(); // 分析表是否无冲突，LALR(1)、LR(1) 模式下即文法是否 LALR(1)、LR(1)
+    SlrTableMode getMode() const; // 分析表的构造方法
     bool bad();
     std::string getReason();
     std::string getError();
-    std::vector<std::vector<Item> > getDfa();
-    int forward(int, std::string);
-    int backward(int, std::string);
-    std::string getStart();
+    const std::vector<std::vector<Item> >& getDfa();
+    void prepare(const SlrProgress& progress = nullptr); // 提前生成First、Follow集合和DFA，取消后不能再使用该对象
+    int forward(int, std::string); // 分析表中的移进或转移目标，没有时返回-1
+    int backward(int, std::string); // 分析表中规约（或接受）所用的产生式编号，没有时返回-1
+    std::string getStart() const;
+    int terminalId(const std::string&) const; // 终结符号编号，不存在时返回-1
+    const std::string& terminalName(int) const;
+    int terminalCount() const;
+    int nonterminalId(const std::string&) const; // 非终结符号编号，不存在时返回-1
+    const std::string& nonterminalName(int) const;
+    const std::string& productionKey(int) const; // 产生式左部
+    const std::vector<std::string>& productionRaws(int) const; // 产生式右部
+    bool fromCache() const; // 分析表是否来自缓存
+    const SlrTable& getTable() const; // 分析表
+    const SlrStats& getStats() const; // 各阶段耗时和计数，parse 的统计为历次累加
+
+    // progress 要求取消时释放已生成的语法树并抛出 SlrCancelled；trace 为 true 时记录解析过程
+    ParsedResult parse(std::string, const SlrProgress& progress = nullptr, bool trace = false); // 解析LEX文件
+    ParsedResult parse(TokenStream&, const std::string&, const SlrProgress& progress = nullptr, bool trace = false); // 解析记号流，区间指向第二个参数
+    // GLR 分析：在分析表的冲突处分叉，分析栈为图结构栈，推导放在共享的压缩分析森林中，不记录解析过程
+    ParsedResult parseGlr(std::string, const SlrProgress& progress = nullptr); // 解析LEX文件
+    ParsedResult parseGlr(TokenStream&, const std::string&, const SlrProgress& progress = nullptr); // 解析记号流，区间指向第二个参数
+};
+
+// 释放语法树
+void freeTree(TreeNode*);
 
-    ParsedResult parse(std::string);
-};
\ No newline at end of file
+#endif // GRAMMER_H
\ No newline at end of file
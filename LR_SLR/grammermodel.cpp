@@ -0,0 +1,243 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 22:27:31
+ * @LastEditTime: 2026-10-19 23:58:44
+ * @FilePath: /LR_SLR/grammermodel.cpp
+ * @Description: 语法树、LR(0) DFA 和 SLR(1) 分析表的数据模型，只在行可见或展开时才读取数据
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#include "grammermodel.h"
+#include <QHeaderView>
+
+// 节点不超过该数量时语法树全部展开，与原先的自动展开一致
+static const size_t EXPAND_ALL_LIMIT = 5000;
+
+ParseTreeModel::ParseTreeModel(TreeNode* root, const QString& message, QObject* parent)
+    : QAbstractItemModel(parent), tree(root), message(message), top(new Row{ nullptr, nullptr, 0 }) {
+    // 虚拟根行的子行固定为一行：语法树根节点或消息
+    top->loaded = true;
+    if (tree || message.size()) top->children.emplace_back(new Row{ tree, top.get(), 0 });
+}
+
+ParseTreeModel::~ParseTreeModel() {
+    freeTree(tree);
+}
+
+ParseTreeModel::Row* ParseTreeModel::rowOf(const QModelIndex& index) const {
+    return index.isValid() ? static_cast<Row*>(index.internalPointer()) : top.get();
+}
+
+void ParseTreeModel::load(Row* row) const {
+    if (row->loaded) return;
+    row->loaded = true;
+    if (!row->node) return;
+    for (TreeNode* child : row->node->children) {
+        if (!child) continue;
+        row->children.emplace_back(new Row{ child, row, (int)row->children.size() });
+    }
+}
+
+QModelIndex ParseTreeModel::index(int row, int column, const QModelIndex& parent) const {
+    Row* parentRow = rowOf(parent);
+    load(parentRow);
+    if (column != 0 || row < 0 || row >= (int)parentRow->children.size()) return QModelIndex();
+    return createIndex(row, column, parentRow->children[row].get());
+}
+
+QModelIndex ParseTreeModel::parent(const QModelIndex& index) const {
+    if (!index.isValid()) return QModelIndex();
+    Row* parentRow = rowOf(index)->parent;
+    if (parentRow == top.get()) return QModelIndex();
+    return createIndex(parentRow->row, 0, parentRow);
+}
+
+int ParseTreeModel::rowCount(const QModelIndex& parent) const {
+    if (parent.column() > 0) return 0;
+    Row* row = rowOf(parent);
+    load(row);
+    return (int)row->children.size();
+}
+
+int ParseTreeModel::columnCount(const QModelIndex&) const {
+    return 1;
+}
+
+bool ParseTreeModel::hasChildren(const QModelIndex& parent) const {
+    // 展开箭头只需知道是否有孩子，不必生成子行
+    Row* row = rowOf(parent);
+    if (row->loaded) return row->children.size() > 0;
+    if (!row->node) return false;
+    for (TreeNode* child : row->node->children) {
+        if (child) return true;
+    }
+    return false;
+}
+
+QVariant ParseTreeModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+    TreeNode* node = rowOf(index)->node;
+    if (!node) return message;
+    QString text = QString::fromStdString(node->label);
+    if (node->value.size()) {
+        text += " : " + QString::fromStdString(node->value);
+    }
+    return text;
+}
+
+size_t ParseTreeModel::nodeCount(size_t limit) const {
+    size_t count = 0;
+    std::vector<TreeNode*> prepared;
+    if (tree) prepared.push_back(tree);
+    while (prepared.size() && count <= limit) {
+        TreeNode* cur = prepared.back();
+        prepared.pop_back();
+        count++;
+        for (TreeNode* child : cur->children) {
+            if (child) prepared.push_back(child);
+        }
+    }
+    return count;
+}
+
+DfaTableModel::DfaTableModel(Grammer& grammer, QObject* parent)
+    : QAbstractTableModel(parent), grammer(grammer), dfa(grammer.getDfa()) {
+    std::string start = grammer.getStart();
+    for (auto& token : grammer.getNotEnd()) {
+        if (token != start) symbols.push_back(token);
+    }
+    for (auto& token : grammer.getEnd()) {
+        symbols.push_back(token);
+    }
+}
+
+int DfaTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : (int)dfa.size();
+}
+
+int DfaTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : (int)symbols.size() + 2;
+}
+
+QString DfaTableModel::itemsOf(int state, const QString& separator) const {
+    const auto& formula = grammer.getFormula();
+    QString text;
+    for (const Item& item : dfa[state]) {
+        const std::string& key = grammer.nonterminalName(item.key);
+        const std::vector<std::string>& raws = formula.at(key)[item.rawsIndex];
+        if (text.size()) text += separator;
+        // 构造类似A -> (.a)
+        text += QString::fromStdString(key) + " -> ";
+        for (int offset = 0; offset < (int)raws.size(); ++offset) {
+            if (offset == item.rawIndex) text += ".";
+            text += QString::fromStdString(raws[offset]);
+        }
+        if (item.rawIndex >= (int)raws.size()) text += ".";
+    }
+    return text;
+}
+
+QVariant DfaTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) return QVariant();
+    int state = index.row();
+    // 项目较多时单元格只显示一行，完整内容见提示
+    if (index.column() == 1 && role == Qt::ToolTipRole) return itemsOf(state, "\n");
+    if (role != Qt::DisplayRole) return QVariant();
+    if (index.column() == 0) return state;
+    if (index.column() == 1) return itemsOf(state, "; ");
+    int target = grammer.forward(state, symbols[index.column() - 2]);
+    if (target < 0) return QVariant();
+    return target;
+}
+
+QVariant DfaTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    if (section == 0) return QString("状态");
+    if (section == 1) return QString("状态内文法");
+    return QString::fromStdString(symbols[section - 2]);
+}
+
+SlrTableModel::SlrTableModel(Grammer& grammer, QObject* parent)
+    : QAbstractTableModel(parent), grammer(grammer), table(grammer.getTable()) {
+    // 列按符号编号排列：非终结符号（起始符号除外），终结符号，结束符
+    int startId = grammer.nonterminalId(grammer.getStart());
+    for (int id = 0; id < table.nonterminalCount; ++id) {
+        if (id != startId) nonterminalColumns.push_back(id);
+    }
+}
+
+int SlrTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : table.stateCount;
+}
+
+int SlrTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : 1 + (int)nonterminalColumns.size() + table.terminalCount;
+}
+
+QVariant SlrTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+    int state = index.row();
+    int column = index.column();
+    if (column == 0) return state;
+    if (column <= (int)nonterminalColumns.size()) {
+        // 转移目标
+        int target = table.gotoOf(state, nonterminalColumns[column - 1]);
+        if (target < 0) return QVariant();
+        return "s" + QString::number(target);
+    }
+    int terminal = column - 1 - (int)nonterminalColumns.size();
+    int32_t entry = table.actionOf(state, terminal);
+    if (entry == SLR_ERROR) return QVariant();
+    QString text = actionText(entry);
+    // 有冲突时一并显示 GLR 分析用到的其余动作
+    auto conflicts = table.conflictsOf(state, terminal);
+    for (const SlrConflict* it = conflicts.first; it != conflicts.second; ++it) {
+        text += " / " + actionText(it->action);
+    }
+    return text;
+}
+
+QString SlrTableModel::actionText(int32_t entry) const {
+    if (SLR_TYPE(entry) == SLR_SHIFT) return "s" + QString::number(SLR_VALUE(entry));
+    if (SLR_TYPE(entry) == SLR_ACCEPT) return QString("ACCEPT");
+    int production = SLR_VALUE(entry);
+    QString text = "r(" + QString::fromStdString(grammer.productionKey(production)) + "->";
+    for (auto& raw : grammer.productionRaws(production)) {
+        text += QString::fromStdString(raw);
+    }
+    return text + ")";
+}
+
+QVariant SlrTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    if (section == 0) return QString("状态");
+    if (section <= (int)nonterminalColumns.size()) {
+        return QString::fromStdString(grammer.nonterminalName(nonterminalColumns[section - 1]));
+    }
+    return QString::fromStdString(grammer.terminalName(section - 1 - (int)nonterminalColumns.size()));
+}
+
+void setupGrammerTableView(QTableView* view, QAbstractItemModel* model) {
+    QAbstractItemModel* old = view->model();
+    view->setModel(model);
+    // 替换掉之前设置的模型（如重新解析文法）
+    if (qobject_cast<DfaTableModel*>(old) || qobject_cast<SlrTableModel*>(old)) old->deleteLater();
+    view->setWordWrap(false);
+    view->verticalHeader()->setVisible(false);
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->verticalHeader()->setDefaultSectionSize(view->fontMetrics().height() + 6);
+    view->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+}
+
+void setupParseTreeView(QTreeView* view, ParseTreeModel* model) {
+    QAbstractItemModel* old = view->model();
+    view->setModel(model);
+    // 旧模型释放时一并释放它持有的语法树
+    if (qobject_cast<ParseTreeModel*>(old)) old->deleteLater();
+    view->setUniformRowHeights(true);
+    if (model->nodeCount(EXPAND_ALL_LIMIT) <= EXPAND_ALL_LIMIT) view->expandAll();
+    else view->expandToDepth(2);
+}
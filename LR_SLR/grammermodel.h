@@ -0,0 +1,106 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 22:27:31
+ * @LastEditTime: 2026-10-19 23:58:44
+ * @FilePath: /LR_SLR/grammermodel.h
+ * @Description: 语法树、LR(0) DFA 和 SLR(1) 分析表的数据模型，只在行可见或展开时才读取数据
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#ifndef GRAMMERMODEL_H
+#define GRAMMERMODEL_H
+
+#include <QAbstractItemModel>
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QTreeView>
+#include "grammer.h"
+#include <memory>
+#include <vector>
+
+// 语法树：持有并在析构时释放语法树，行节点在父节点首次展开时才生成
+// 语义动作可能让同一节点出现在多处，因此行节点按出现位置而不是语法树节点区分
+class ParseTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    // root 为空时只显示一行 message（如解析错误）
+    explicit ParseTreeModel(TreeNode* root, const QString& message = QString(), QObject* parent = nullptr);
+    ~ParseTreeModel();
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // 语法树节点数（按出现位置计），超过 limit 时不再继续计数，用于决定是否全部展开
+    size_t nodeCount(size_t limit) const;
+
+private:
+    struct Row {
+        TreeNode* node; // 为空时是消息行
+        Row* parent;
+        int row; // 在父行中的下标
+        bool loaded = false; // 子行是否已生成
+        std::vector<std::unique_ptr<Row> > children;
+    };
+
+    TreeNode* tree;
+    QString message;
+    std::unique_ptr<Row> top; // 不显示的虚拟根行，子行为语法树根节点或消息行
+
+    Row* rowOf(const QModelIndex& index) const;
+    // 首次访问时生成子行，跳过语义动作留下的空位
+    void load(Row* row) const;
+};
+
+// LR(0) DFA：每行一个状态，第1列为状态内的项目，之后为非终结符号（起始符号除外）和终结符号上的转移
+class DfaTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    explicit DfaTableModel(Grammer& grammer, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    Grammer& grammer;
+    const std::vector<std::vector<Item> >& dfa;
+    std::vector<std::string> symbols; // 各转移列的符号
+
+    // 状态内的项目，如 A -> a.B，separator 分隔各项目
+    QString itemsOf(int state, const QString& separator) const;
+};
+
+// SLR(1) 分析表：直接读取扁平分析表，命中缓存时无需生成DFA
+class SlrTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    explicit SlrTableModel(Grammer& grammer, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    Grammer& grammer;
+    const SlrTable& table;
+    std::vector<int> nonterminalColumns; // 非终结符号列对应的编号，起始符号除外
+
+    // 动作的显示文字，如 s5、r(A->ab)、ACCEPT
+    QString actionText(int32_t entry) const;
+};
+
+// 表格视图的通用设置：固定行高、列宽可调，行数很多时也不需要逐行测量
+// model 为空时清空视图，之前设置的模型随后释放
+void setupGrammerTableView(QTableView* view, QAbstractItemModel* model);
+// 语法树视图：节点不多时全部展开，否则只展开前几层
+void setupParseTreeView(QTreeView* view, ParseTreeModel* model);
+
+#endif // GRAMMERMODEL_H
@@ -1,12 +1,19 @@
 /*
  * @Author: 20212131001 翁行
  * @Date: 2024-05-23 13:19:28
- * @LastEditTime: 2024-05-29 13:01:29
+ * @LastEditTime: 2026-10-19 23:59:58
  * @FilePath: /LR_SLR/mainwindow.cpp
  * @Description: QT主窗口
  * Copyright (c) 2024 by wengx00, All Rights Reserved.
  *
  * 版本历史
+ * 2026/10/19 feat: 可选 GLR 分析语句，显示歧义节点数
+ * 2026/10/19 feat: 可选 LR(1) 分析表，性能统计页对比 SLR(1) 的状态数
+ * 2026/10/19 feat: 可选 LALR(1) 分析表，文法错误处显示分析表冲突
+ * 2026/10/19 perf: 语法树、DFA 表和 SLR 表改用按需读取的数据模型
+ * 2026/10/19 feat: 文法分析和语句解析移到后台线程，显示进度并支持取消
+ * 2026/10/19 feat: 性能统计页
+ * 2026/10/19 feat: 分析表缓存，SLR表直接读取扁平分析表
  * 2024/5/23 feat: 导入LEX文件
  * 2024/5/23 feat: 语法树自动展开和TAB切换
  * 2024/5/21 feat：显示语法树
@@ -17,20 +24,151 @@
  */
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "grammermodel.h"
 #include <QFileDialog>
+#include <QLabel>
 #include <QMessageBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QStandardPaths>
+#include <QThread>
+#include <chrono>
+#include <climits>
+#include <memory>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow), currentGrammer(nullptr) {
     ui->setupUi(this);
+    // 状态栏：任务说明、进度条和取消按钮，空闲时只显示说明
+    progressLabel = new QLabel(this);
+    progressBar = new QProgressBar(this);
+    progressBar->setMaximumWidth(240);
+    progressBar->setTextVisible(false);
+    cancelButton = new QPushButton("取消", this);
+    ui->statusbar->addWidget(progressLabel, 1);
+    ui->statusbar->addPermanentWidget(progressBar);
+    ui->statusbar->addPermanentWidget(cancelButton);
+    progressBar->setVisible(false);
+    cancelButton->setVisible(false);
+    connect(cancelButton, &QPushButton::clicked, this, [this]() {
+        cancelRequested = true;
+        cancelButton->setEnabled(false);
+        progressLabel->setText("正在取消...");
+    });
 }
 
 MainWindow::~MainWindow() {
+    // 先停止后台任务，再释放它正在使用的文法
+    if (worker) {
+        cancelRequested = true;
+        worker->wait();
+        delete worker;
+    }
     delete ui;
     if (currentGrammer) delete currentGrammer;
 }
 
+void MainWindow::startWork(const QString& title, Job job) {
+    cancelRequested = false;
+    ui->toParseGrammer->setEnabled(false);
+    ui->toParseStatement->setEnabled(false);
+    ui->tableMode->setEnabled(false);
+    ui->glrParse->setEnabled(false);
+    progressLabel->setText(title);
+    progressBar->setRange(0, 0);
+    progressBar->setVisible(true);
+    cancelButton->setEnabled(true);
+    cancelButton->setVisible(true);
+
+    // 回调在后台线程上执行，进度按时间节流后投递到界面线程
+    std::chrono::steady_clock::time_point lastPost;
+    SlrProgress progress = [this, lastPost](SlrProgressStage stage, size_t done, size_t total) mutable {
+        if (cancelRequested) return false;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPost < std::chrono::milliseconds(100)) return true;
+        lastPost = now;
+        QMetaObject::invokeMethod(this, [this, stage, done, total]() {
+            onProgress(stage, done, total);
+        }, Qt::QueuedConnection);
+        return true;
+    };
+    worker = QThread::create([this, job, progress]() {
+        std::function<void()> done;
+        bool cancelled = false;
+        QString error;
+        try {
+            done = job(progress);
+        }
+        catch (const SlrCancelled&) {
+            cancelled = true;
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        QMetaObject::invokeMethod(this, [this, done, cancelled, error]() {
+            finishWork();
+            if (done) {
+                done();
+                return;
+            }
+            if (cancelled) {
+                progressLabel->setText("已取消");
+                return;
+            }
+            progressLabel->setText("失败：" + error);
+            QMessageBox::warning(this, "提示", "执行失败：" + error);
+        }, Qt::QueuedConnection);
+    });
+    worker->start();
+}
+
+// 回收后台线程，恢复按钮和状态栏
+void MainWindow::finishWork() {
+    worker->wait();
+    delete worker;
+    worker = nullptr;
+    progressLabel->clear();
+    progressBar->setVisible(false);
+    cancelButton->setVisible(false);
+    ui->toParseGrammer->setEnabled(true);
+    ui->toParseStatement->setEnabled(true);
+    ui->tableMode->setEnabled(true);
+    ui->glrParse->setEnabled(true);
+}
+
+// 显示当前阶段的进度
+void MainWindow::onProgress(SlrProgressStage stage, size_t done, size_t total) {
+    switch (stage) {
+    case SLR_PROGRESS_FIRST:
+        progressLabel->setText("计算 First 集合...");
+        progressBar->setRange(0, 0);
+        return;
+    case SLR_PROGRESS_FOLLOW:
+        progressLabel->setText("计算 Follow 集合...");
+        progressBar->setRange(0, 0);
+        return;
+    case SLR_PROGRESS_AUTOMATON:
+        progressLabel->setText(QString("构造项目集规范族：%1 / %2 个状态").arg(done).arg(total));
+        break;
+    case SLR_PROGRESS_LOOKAHEAD:
+        progressLabel->setText("计算 LALR(1) 向前看集合...");
+        progressBar->setRange(0, 0);
+        return;
+    case SLR_PROGRESS_TABLE:
+        progressLabel->setText("生成分析表...");
+        progressBar->setRange(0, 0);
+        return;
+    case SLR_PROGRESS_PARSE:
+        progressLabel->setText(QString("语法分析：已读取 %1 / %2 KB").arg(done / 1024).arg(total / 1024));
+        break;
+    }
+    // 进度条只支持 int
+    int scale = total > (size_t)INT_MAX ? (int)(total / INT_MAX + 1) : 1;
+    progressBar->setRange(0, (int)(total / scale));
+    progressBar->setValue((int)(done / scale));
+}
+
 // 渲染基本信息（语法错误、first和follow集合、文法预览）
 void MainWindow::renderBasicInfo() {
     if (!currentGrammer) {
@@ -39,6 +177,11 @@ void MainWindow::renderBasicInfo() {
     }
     Grammer& grammer = *currentGrammer;
     QString error = QString::fromStdString(grammer.getError());
+    // 分析表有冲突时显示原因，冲突按移进优先、先出现的产生式优先处理
+    if (error.isEmpty() && !grammer.slr()) {
+        error = QString("不是 %1 文法，分析表有冲突：\n").arg(slrTableModeName(grammer.getMode()))
+            + QString::fromStdString(grammer.getReason());
+    }
     if (error.isEmpty()) error = "未发现错误";
     ui->syntaxError->setPlainText(error);
     QString followSet, firstSet;
@@ -74,175 +217,100 @@ void MainWindow::renderDfaTable() {
         QMessageBox::information(this, "提示", "请先点击解析文法");
         return;
     }
-    Grammer& grammer = *currentGrammer;
-    std::vector<std::vector<Item> > dfa = grammer.getDfa();
-    std::set<std::string> endSet = grammer.getEnd();
-    std::set<std::string> notEndSet = grammer.getNotEnd();
-    std::string startToken = grammer.getStart();
-    auto* table = ui->dfa;
-    table->setColumnCount(1 + endSet.size() + notEndSet.size());
-    table->setRowCount(dfa.size());
-    QStringList header;
-    header << "状态" << "状态内文法";
-    for (auto& token : notEndSet) {
-        if (token == startToken) continue;
-        header << QString::fromStdString(token);
-    }
-    for (auto& token : endSet) {
-        header << QString::fromStdString(token);
-    }
-    table->setHorizontalHeaderLabels(header);
-    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-    // 文法
-    auto formula = grammer.getFormula();
-    // 迭代生成cell
-    for (int state = 0; state < (int)dfa.size(); ++state) {
-        QTableWidgetItem* id = new QTableWidgetItem(); // 状态编号
-        QTableWidgetItem* inner = new QTableWidgetItem(); // 状态内文法
-
-        id->setText(QString::fromStdString(std::to_string(state)));
-        table->setItem(state, 0, id); // 加入编号列
-
-        QString innerText;
-        for (int offset = 0; offset < (int)dfa[state].size(); ++offset) {
-            // 遍历节点内部
-            Item& cur = dfa[state][offset];
-            std::vector<std::string> rawOfCur = formula[cur.key][cur.rawsIndex]; // 那一行文法
-            innerText += QString::fromStdString(cur.key) + " -> ";
-            for (int tokenOffset = 0; tokenOffset <= (int)rawOfCur.size(); ++tokenOffset) {
-                // 构造类似A -> (.a)
-                if (tokenOffset == cur.rawIndex) innerText += ".";
-                innerText += QString::fromStdString(rawOfCur[tokenOffset]);
-            }
-            innerText += "\n";
-        }
-        inner->setText(innerText);
-        table->setItem(state, 1, inner);
-
-        int col = 2;
-        for (auto& token : notEndSet) {
-            if (token == startToken) continue;
-            int target = grammer.forward(state, token);
-            if (target >= 0) {
-                QTableWidgetItem* item = new QTableWidgetItem();
-                item->setText(QString::fromStdString(std::to_string(target)));
-                table->setItem(state, col, item);
-            }
-            col++;
-        }
-        for (auto& token : endSet) {
-            int target = grammer.forward(state, token);
-            if (target >= 0) {
-                QTableWidgetItem* item = new QTableWidgetItem();
-                item->setText(QString::fromStdString(std::to_string(target)));
-                table->setItem(state, col, item);
-            }
-            col++;
-        }
-    }
-
+    setupGrammerTableView(ui->dfa, new DfaTableModel(*currentGrammer, this));
 }
 
-// 渲染SLR表
+// 渲染SLR表，直接读取分析表，命中缓存时无需生成DFA
 void MainWindow::renderSlrTable() {
-    Grammer& grammer = *currentGrammer;
-    std::set<std::string> endSet = grammer.getEnd();
-    std::set<std::string> notEndSet = grammer.getNotEnd();
-    std::string startToken = grammer.getStart();
-    auto dfa = grammer.getDfa();
-    auto formula = grammer.getFormula();
-    endSet.insert(END_FLAG);
+    ui->label_9->setText(QString("%1 分析表").arg(slrTableModeName(currentGrammer->getMode())));
+    setupGrammerTableView(ui->slr, new SlrTableModel(*currentGrammer, this));
+}
 
-    auto* table = ui->slr;
-    table->setColumnCount(endSet.size() + notEndSet.size());
-    table->setRowCount(dfa.size());
-    QStringList header;
-    header << "状态";
-    for (auto& token : notEndSet) {
-        if (token == startToken) continue;
-        header << QString::fromStdString(token);
+// 渲染各阶段耗时和计数，语法分析为历次累计
+void MainWindow::renderStats() {
+    if (!currentGrammer) return;
+    const SlrStats& stats = currentGrammer->getStats();
+    const std::pair<QString, const SlrStage*> stages[] = {
+        { "读取文法", &stats.grammar },
+        { "First 集合", &stats.first },
+        { "Follow 集合", &stats.follow },
+        { "LR(0) DFA", &stats.automaton },
+        { "向前看集合和规约", &stats.lookahead },
+        { "分析表", &stats.table },
+        { "缓存读写", &stats.cache },
+        { "语法分析", &stats.parse },
+    };
+    bool memory = slrMemoryCounted();
+    QString text;
+    for (auto& it : stages) {
+        if (!it.second->runs) continue;
+        text += QString("%1: %2 ms").arg(it.first).arg(it.second->ms, 0, 'f', 3);
+        if (it.second->runs > 1) text += QString("（%1 次）").arg(it.second->runs);
+        if (memory) {
+            const SlrStage& stage = *it.second;
+            text += QString("，分配 %1 KB / %2 次，留存 %3 KB，峰值 %4 KB")
+                .arg(stage.allocated / 1024.0, 0, 'f', 1)
+                .arg(stage.allocations)
+                .arg(stage.retained / 1024.0, 0, 'f', 1)
+                .arg(stage.peak / 1024.0, 0, 'f', 1);
+        }
+        text += "\n";
     }
-    for (auto& token : endSet) {
-        header << QString::fromStdString(token);
+    if (stats.cached) text += "分析表来自缓存\n";
+    text += "\n";
+    text += QString("First 依赖图强连通分量数: %1\n").arg(stats.firstComponents);
+    text += QString("Follow 依赖图强连通分量数: %1\n").arg(stats.followComponents);
+    text += QString("项目集闭包计算次数: %1\n").arg(stats.closures);
+    text += QString("项目集查找次数: %1\n").arg(stats.itemSetComparisons);
+    text += QString("DFA 状态数: %1\n").arg(stats.states);
+    text += QString("项目总数: %1\n").arg(stats.items);
+    if (currentGrammer->getMode() == SLR_MODE_LALR) text += QString("非终结符号转移数: %1\n").arg(stats.transitions);
+    if (currentGrammer->getMode() == SLR_MODE_LR1 && !stats.cached) {
+        text += QString("不同核心数（SLR(1) 状态数）: %1\n").arg(stats.cores);
+        text += QString("同核心状态合并次数: %1\n").arg(stats.merges);
     }
-    table->setHorizontalHeaderLabels(header);
-    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-
-    // Cell
-    for (int state = 0; state < (int)dfa.size(); ++state) {
-        QTableWidgetItem* id = new QTableWidgetItem(); // 状态编号
-        id->setText(QString::number(state));
-        table->setItem(state, 0, id);
-
-        int column = 1;
-        for (auto& token : notEndSet) {
-            if (token == startToken) continue;
-            // 移进目标
-            int target = grammer.forward(state, token);
-            if (target > -1) {
-                QTableWidgetItem* end = new QTableWidgetItem(); // 状态编号
-                end->setText("s" + QString::number(target));
-                table->setItem(state, column, end);
-            }
-            // 规约目标
-            else if ((target = grammer.backward(state, token)) > -1) {
-                QTableWidgetItem* end = new QTableWidgetItem(); // 状态编号
-                Item& node = dfa[state][target];
-                if (node.key == startToken) {
-                    end->setText("ACCEPT");
-                }
-                else {
-                    QString endText = "r(" + QString::fromStdString(node.key) + "->";
-                    for (auto& token : formula[node.key][node.rawsIndex]) {
-                        endText += QString::fromStdString(token);
-                    }
-                    endText += ")";
-                    end->setText(endText);
-                }
-                table->setItem(state, column, end);
-            }
-            column++;
-        }
-        for (auto& token : endSet) {
-            int target = grammer.forward(state, token);
-            if (target > -1) {
-                QTableWidgetItem* end = new QTableWidgetItem(); // 状态编号
-                end->setText("s" + QString::number(target));
-                table->setItem(state, column, end);
-            }
-            else if ((target = grammer.backward(state, token)) > -1) {
-                QTableWidgetItem* end = new QTableWidgetItem(); // 状态编号
-                Item& node = dfa[state][target];
-                if (node.key == startToken) {
-                    end->setText("ACCEPT");
-                }
-                else {
-                    QString endText = "r(" + QString::fromStdString(node.key) + "->";
-                    for (auto& token : formula[node.key][node.rawsIndex]) {
-                        endText += QString::fromStdString(token);
-                    }
-                    endText += ")";
-                    end->setText(endText);
-                }
-                table->setItem(state, column, end);
-            }
-            column++;
-        }
-
+    text += QString("移进次数: %1\n").arg(stats.shifts);
+    text += QString("规约次数: %1\n").arg(stats.reductions);
+    if (stats.stackNodes) {
+        text += QString("GLR 图结构栈节点数: %1\n").arg(stats.stackNodes);
+        text += QString("GLR 分析森林节点数: %1\n").arg(stats.forestNodes);
+        text += QString("GLR 歧义节点数: %1\n").arg(stats.ambiguities);
     }
+    ui->statsView->setPlainText(text);
 }
 
-// 解析文法
+// 解析文法：在后台生成文法、分析表和DFA，完成后替换当前文法
 void MainWindow::on_toParseGrammer_clicked() {
     std::string grammerStr = ui->grammer->toPlainText().toStdString();
-    Grammer* grammer = new Grammer(grammerStr);
-    currentGrammer = grammer;
-    renderBasicInfo();
-    if (!grammer->bad()) {
-        renderDfaTable();
-        renderSlrTable();
-    }
-    ui->resultTab->setCurrentIndex(0);
+    // 分析表按文法哈希缓存在用户缓存目录下
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/grammars";
+    QDir().mkpath(cacheDir);
+    std::string cachePath = cacheDir.toUtf8().toStdString();
+    // 下拉框各项与 SlrTableMode 的取值顺序一致
+    SlrTableMode mode = (SlrTableMode)ui->tableMode->currentIndex();
+    startWork("正在分析文法...", [this, grammerStr, cachePath, mode](const SlrProgress& progress) -> std::function<void()> {
+        std::unique_ptr<Grammer> created(new Grammer(grammerStr, cachePath, progress, mode));
+        // 命中缓存时界面仍要显示 First、Follow 集合和DFA，一并在后台生成
+        created->prepare(progress);
+        Grammer* grammer = created.release();
+        return [this, grammer]() {
+            // 表格模型引用着文法，先换上新模型再释放旧文法
+            Grammer* old = currentGrammer;
+            currentGrammer = grammer;
+            renderBasicInfo();
+            if (!grammer->bad()) {
+                renderDfaTable();
+                renderSlrTable();
+            }
+            else {
+                setupGrammerTableView(ui->dfa, nullptr);
+                setupGrammerTableView(ui->slr, nullptr);
+            }
+            if (old) delete old;
+            renderStats();
+            ui->resultTab->setCurrentIndex(0);
+        };
+    });
 }
 
 // 导入文法文件
@@ -298,44 +366,38 @@ void MainWindow::on_toParseStatement_clicked() {
         QMessageBox::information(this, "提示", "请先解析文法后再解析语句");
         return;
     }
-    qDebug() << "待解析语句: " << statement;
-    Grammer& grammer = *currentGrammer;
-    ParsedResult result = grammer.parse(statement.toStdString());
-    ui->treeWidget->clear();
+    // 解析期间解析按钮被禁用，当前文法不会被替换
+    Grammer* grammer = currentGrammer;
+    std::string input = statement.toStdString();
+    bool glr = ui->glrParse->isChecked();
+    startWork("正在解析语句...", [this, grammer, input, glr](const SlrProgress& progress) -> std::function<void()> {
+        std::shared_ptr<ParsedResult> result = std::make_shared<ParsedResult>(
+            glr ? grammer->parseGlr(input, progress) : grammer->parse(input, progress));
+        return [this, result]() {
+            showParsed(*result);
+        };
+    });
+}
+
+// 显示语句解析结果，语法树交给模型持有
+void MainWindow::showParsed(ParsedResult& result) {
+    renderStats();
     if (result.error.size() == 0) {
-        traverseTree(result.root, 0);
-        QMessageBox::information(this, "提示", "语法树解析成功");
+        setupParseTreeView(ui->parseTree, new ParseTreeModel(result.root, QString(), this));
+        result.root = nullptr;
+        if (result.ambiguities) {
+            QMessageBox::information(this, "提示", QString("语法树解析成功，语句有歧义（%1 个节点有多种推导），显示的是最先得到的推导").arg(result.ambiguities));
+        }
+        else QMessageBox::information(this, "提示", "语法树解析成功");
     }
     else {
-        QTreeWidgetItem* item = new QTreeWidgetItem(ui->treeWidget);
-        item->setText(0, QString::fromStdString(result.error));
+        setupParseTreeView(ui->parseTree, new ParseTreeModel(nullptr, QString::fromStdString(result.error), this));
         QMessageBox::warning(this, "提示", "语法树解析失败");
     }
     ui->resultTab->setCurrentIndex(1);
 }
 
 
-// 遍历树生成QTreeWidgetItem节点
-void MainWindow::traverseTree(TreeNode* tree, QTreeWidgetItem* p) {
-    if (tree == NULL) return;
-    QTreeWidgetItem* item;
-    if (p == 0)
-        item = new QTreeWidgetItem(ui->treeWidget);
-    else
-        item = new QTreeWidgetItem(p);
-    QString text = QString::fromStdString(tree->label);
-    if (tree->value.size()) {
-        text += " : " + QString::fromStdString(tree->value);
-    }
-    item->setText(0, text);
-    item->setForeground(0, Qt::black);
-    item->setExpanded(true);
-    for (TreeNode* child : tree->children) {
-        traverseTree(child, item);
-    }
-}
-
-
 // 导入LEX文件
 void MainWindow::on_importLex_clicked() {
     // 获取文件名
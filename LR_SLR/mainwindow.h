@@ -1,7 +1,7 @@
 /*
  * @Author: 20212131001 翁行
  * @Date: 2024-05-23 13:19:39
- * @LastEditTime: 2024-05-23 13:48:41
+ * @LastEditTime: 2026-10-19 22:27:31
  * @FilePath: /LR_SLR/mainwindow.h
  * @Description: QT主窗口头文件
  * Copyright (c) 2024 by wengx00, All Rights Reserved.
@@ -12,13 +12,19 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTreeWidgetItem>
 #include "grammer.h"
+#include <atomic>
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QThread;
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -38,11 +44,25 @@ private slots:
     void on_importLex_clicked();
 
 private:
+    // 后台任务：在工作线程上执行，返回完成后在界面线程上执行的操作
+    typedef std::function<std::function<void()>(const SlrProgress&)> Job;
+
     Ui::MainWindow* ui;
+    QLabel* progressLabel; // 状态栏上的任务进度
+    QProgressBar* progressBar;
+    QPushButton* cancelButton;
+    QThread* worker = nullptr; // 后台任务线程，空闲时为空
+    std::atomic<bool> cancelRequested{ false };
+
+    // 同一时间只运行一个后台任务，运行期间禁用解析按钮
+    void startWork(const QString& title, Job job);
+    void finishWork();
+    void onProgress(SlrProgressStage stage, size_t done, size_t total);
+    void showParsed(ParsedResult& result);
     void renderBasicInfo();
     void renderDfaTable();
     void renderSlrTable();
-    void traverseTree(TreeNode*, QTreeWidgetItem*);
+    void renderStats();
     Grammer* currentGrammer;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,252 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 17:55:36
+ * @LastEditTime: 2026-10-19 23:59:18
+ * @FilePath: /LR_SLR/slrcache.cpp
+ * @Description: SLR 分析表的持久化缓存：按文法文本哈希存取，读取时直接映射文件
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#include "slrcache.h"
+#include "cachefile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+    const char MAGIC[8] = { 'S', 'L', 'R', 'T', 'A', 'B', 'L', 'E' };
+    const uint32_t ENDIAN_MARK = 0x01020304;
+
+    // 各段下标
+    enum Section { ACTION, GOTOS, PRODUCTIONS, TREE, CONFLICTS, META, SECTION_COUNT };
+
+    // 文件头
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint64_t grammerHash;
+        int32_t stateCount;
+        int32_t terminalCount;
+        int32_t nonterminalCount;
+        int32_t productionCount;
+        int32_t treeCount;
+        int32_t conflictCount;
+        int32_t slr;
+        uint64_t fileSize;
+        uint64_t offsets[SECTION_COUNT];
+        uint64_t sizes[SECTION_COUNT];
+    };
+
+    void putStrings(string& buf, const vector<string>& strs) {
+        uint32_t size = strs.size();
+        buf.append((const char*)&size, sizeof(size));
+        for (auto& str : strs) putCacheString(buf, str);
+    }
+
+    // 读取 putStrings 写入的字符串列表，越界时返回false
+    bool getStrings(CacheReader& reader, vector<string>& strs) {
+        uint32_t size;
+        if (!reader.getSize(size)) return false;
+        strs.clear();
+        for (uint32_t i = 0; i < size; ++i) {
+            string str;
+            if (!reader.getString(str)) return false;
+            strs.push_back(str);
+        }
+        return true;
+    }
+
+    void putProductions(string& buf, const vector<vector<int> >& productions) {
+        uint32_t size = productions.size();
+        buf.append((const char*)&size, sizeof(size));
+        for (auto& production : productions) {
+            size = production.size();
+            buf.append((const char*)&size, sizeof(size));
+            buf.append((const char*)production.data(), production.size() * sizeof(int));
+        }
+    }
+
+    // 读取 putProductions 写入的产生式，越界时返回false
+    bool getProductions(CacheReader& reader, vector<vector<int> >& productions) {
+        uint32_t size;
+        if (!reader.getSize(size)) return false;
+        productions.clear();
+        for (uint32_t i = 0; i < size; ++i) {
+            uint32_t length;
+            if (!reader.getSize(length) || (uint64_t)(reader.end - reader.p) < (uint64_t)length * sizeof(int)) return false;
+            productions.emplace_back(length);
+            if (length) memcpy(productions.back().data(), reader.p, length * sizeof(int));
+            reader.p += length * sizeof(int);
+        }
+        return true;
+    }
+
+    // 校验一个动作的目标状态或产生式编号
+    bool checkEntry(const CacheHeader& header, int32_t entry) {
+        int32_t value = SLR_VALUE(entry);
+        switch (SLR_TYPE(entry)) {
+        case SLR_ERROR:
+            return value == 0;
+        case SLR_SHIFT:
+            return value >= 0 && value < header.stateCount;
+        default:
+            return value >= 0 && value < header.productionCount;
+        }
+    }
+
+    // 校验表项，防止映射的数据让分析程序读到表外
+    bool checkTable(const CacheHeader& header, const char* data) {
+        const int32_t* action = (const int32_t*)(data + header.offsets[ACTION]);
+        const int32_t* gotos = (const int32_t*)(data + header.offsets[GOTOS]);
+        const SlrProduction* productions = (const SlrProduction*)(data + header.offsets[PRODUCTIONS]);
+        const SlrConflict* conflicts = (const SlrConflict*)(data + header.offsets[CONFLICTS]);
+        size_t actions = (size_t)header.stateCount * header.terminalCount;
+        for (size_t i = 0; i < actions; ++i) {
+            if (!checkEntry(header, action[i])) return false;
+        }
+        // 冲突按表项升序排列，查找时依赖这一顺序
+        for (int i = 0; i < header.conflictCount; ++i) {
+            const SlrConflict& conflict = conflicts[i];
+            if (conflict.cell < 0 || (size_t)conflict.cell >= actions || (i && conflict.cell < conflicts[i - 1].cell)
+                || conflict.action == SLR_ERROR || !checkEntry(header, conflict.action)) {
+                return false;
+            }
+        }
+        size_t entries = (size_t)header.stateCount * header.nonterminalCount;
+        for (size_t i = 0; i < entries; ++i) {
+            if (gotos[i] < -1 || gotos[i] >= header.stateCount) return false;
+        }
+        const SlrTreeAction* tree = (const SlrTreeAction*)(data + header.offsets[TREE]);
+        for (int i = 0; i < header.productionCount; ++i) {
+            const SlrProduction& production = productions[i];
+            if (production.key < 0 || production.key >= header.nonterminalCount || production.length < 0
+                || production.treeBegin < 0 || production.treeBegin > production.treeEnd || production.treeEnd > header.treeCount) {
+                return false;
+            }
+            // 语义动作按下标取规约出栈的节点，与 initTable 的要求相同
+            for (int j = production.treeBegin; j < production.treeEnd; ++j) {
+                if (tree[j].index < 0 || tree[j].index >= production.length || tree[j].value < -1) return false;
+            }
+        }
+        return true;
+    }
+}
+
+uint64_t hashGrammerText(const string& text, SlrTableMode mode) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    // 其它构造方法在文本后接上 0 和方法编号，文法文本本身不含 0
+    if (mode != SLR_MODE_SLR) {
+        hash *= 1099511628211ull;
+        hash ^= (unsigned char)mode;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+string slrCachePath(const string& dir, const string& text, SlrTableMode mode) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.slrc", (unsigned long long)hashGrammerText(text, mode));
+    return (fs::u8path(dir) / name).u8string();
+}
+
+bool saveSlrCache(const string& path, uint64_t hash, const SlrTable& table, const SlrCacheMeta& meta, string& error) {
+    string metaBuffer;
+    putStrings(metaBuffer, meta.terminals);
+    putStrings(metaBuffer, meta.nonterminals);
+    putCacheString(metaBuffer, meta.reason);
+    putProductions(metaBuffer, meta.productions);
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = SLR_CACHE_VERSION;
+    header.endian = ENDIAN_MARK;
+    header.grammerHash = hash;
+    header.stateCount = table.stateCount;
+    header.terminalCount = table.terminalCount;
+    header.nonterminalCount = table.nonterminalCount;
+    header.productionCount = table.productionCount;
+    header.treeCount = table.treeCount;
+    header.conflictCount = table.conflictCount;
+    header.slr = meta.slr ? 1 : 0;
+    const void* sections[SECTION_COUNT] = { table.action, table.gotos, table.productions, table.tree, table.conflicts, metaBuffer.data() };
+    header.sizes[ACTION] = (uint64_t)table.stateCount * table.terminalCount * sizeof(int32_t);
+    header.sizes[GOTOS] = (uint64_t)table.stateCount * table.nonterminalCount * sizeof(int32_t);
+    header.sizes[PRODUCTIONS] = (uint64_t)table.productionCount * sizeof(SlrProduction);
+    header.sizes[TREE] = (uint64_t)table.treeCount * sizeof(SlrTreeAction);
+    header.sizes[CONFLICTS] = (uint64_t)table.conflictCount * sizeof(SlrConflict);
+    header.sizes[META] = metaBuffer.size();
+    header.fileSize = layoutCacheSections(sizeof(header), header.sizes, header.offsets, SECTION_COUNT);
+    return writeCacheFile(path, &header, sizeof(header), sections, header.offsets, header.sizes, SECTION_COUNT, header.fileSize, error);
+}
+
+bool loadSlrCache(const string& path, uint64_t hash, SlrTable& table, SlrCacheMeta& meta, string& error) {
+    shared_ptr<MappedFile> file = make_shared<MappedFile>();
+    if (!file->open(path)) {
+        error = "无法读取缓存文件 " + path;
+        return false;
+    }
+    const char* data = file->data();
+    CacheHeader header;
+    if (file->size() < sizeof(header)) {
+        error = "缓存文件不完整";
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.endian != ENDIAN_MARK) {
+        error = "不是有效的缓存文件";
+        return false;
+    }
+    if (header.version != SLR_CACHE_VERSION) {
+        error = "缓存文件版本不符";
+        return false;
+    }
+    if (header.grammerHash != hash) {
+        error = "缓存文件与文法不符";
+        return false;
+    }
+    if (header.fileSize != file->size() || header.stateCount <= 0 || header.terminalCount <= 0
+        || header.nonterminalCount <= 0 || header.productionCount <= 0 || header.treeCount < 0 || header.conflictCount < 0
+        || header.sizes[ACTION] != (uint64_t)header.stateCount * header.terminalCount * sizeof(int32_t)
+        || header.sizes[GOTOS] != (uint64_t)header.stateCount * header.nonterminalCount * sizeof(int32_t)
+        || header.sizes[PRODUCTIONS] != (uint64_t)header.productionCount * sizeof(SlrProduction)
+        || header.sizes[TREE] != (uint64_t)header.treeCount * sizeof(SlrTreeAction)
+        || header.sizes[CONFLICTS] != (uint64_t)header.conflictCount * sizeof(SlrConflict)) {
+        error = "缓存文件已损坏";
+        return false;
+    }
+    if (!checkCacheSections(header.offsets, header.sizes, SECTION_COUNT, header.fileSize)) {
+        error = "缓存文件已损坏";
+        return false;
+    }
+    CacheReader reader{ data + header.offsets[META], data + header.offsets[META] + header.sizes[META] };
+    if (!checkTable(header, data)
+        || !getStrings(reader, meta.terminals) || !getStrings(reader, meta.nonterminals) || !reader.getString(meta.reason)
+        || !getProductions(reader, meta.productions)
+        || meta.terminals.size() != (size_t)header.terminalCount || meta.nonterminals.size() != (size_t)header.nonterminalCount) {
+        error = "缓存文件已损坏";
+        return false;
+    }
+    meta.slr = header.slr != 0;
+
+    table.stateCount = header.stateCount;
+    table.terminalCount = header.terminalCount;
+    table.nonterminalCount = header.nonterminalCount;
+    table.productionCount = header.productionCount;
+    table.treeCount = header.treeCount;
+    table.action = (const int32_t*)(data + header.offsets[ACTION]);
+    table.gotos = (const int32_t*)(data + header.offsets[GOTOS]);
+    table.productions = (const SlrProduction*)(data + header.offsets[PRODUCTIONS]);
+    table.tree = (const SlrTreeAction*)(data + header.offsets[TREE]);
+    table.conflictCount = header.conflictCount;
+    table.conflicts = (const SlrConflict*)(data + header.offsets[CONFLICTS]);
+    table.storage = file;
+    return true;
+}
@@ -0,0 +1,52 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 17:55:36
+ * @LastEditTime: 2026-10-19 23:59:58
+ * @FilePath: /LR_SLR/slrcache.h
+ * @Description: SLR 分析表的持久化缓存：按文法文本哈希存取，读取时直接映射文件
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#ifndef SLRCACHE_H
+#define SLRCACHE_H
+
+#include "slrtable.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 缓存文件格式版本，格式或分析表构建语义变化时需递增
+#define SLR_CACHE_VERSION 7 // 7：规约-规约冲突按产生式编号处理
+
+/**
+ * 缓存文件布局（小端、8字节对齐，可直接映射使用）：
+ * 文件头 magic "SLRTABLE"、版本、字节序标记、文法哈希、各项数量、各段偏移和长度
+ * action 段：stateCount * terminalCount 个 int32
+ * gotos 段：stateCount * nonterminalCount 个 int32
+ * productions 段：productionCount 个 SlrProduction
+ * tree 段：treeCount 个 SlrTreeAction
+ * conflicts 段：conflictCount 个 SlrConflict
+ * meta 段：终结符号名、非终结符号名、分析表有冲突的原因（长度前缀字符串），各产生式的左部和右部符号编号
+ */
+
+// 缓存中和分析表一起保存的文法信息
+struct SlrCacheMeta {
+    std::vector<std::string> terminals;
+    std::vector<std::string> nonterminals;
+    bool slr = false; // 分析表是否无冲突
+    std::string reason;
+    std::vector<std::vector<int> > productions; // 各产生式：左部非终结符号编号，后接右部符号编号
+};
+
+// 文法文本和分析表构造方法的哈希（FNV-1a 64），作为缓存的键；SLR(1) 的哈希只含文法文本
+uint64_t hashGrammerText(const std::string& text, SlrTableMode mode = SLR_MODE_SLR);
+
+// 文法在缓存目录下对应的缓存文件路径，不同构造方法的分析表分别缓存
+std::string slrCachePath(const std::string& dir, const std::string& text, SlrTableMode mode = SLR_MODE_SLR);
+
+// 写入缓存文件（先写临时文件再改名），失败时返回false并写入error
+bool saveSlrCache(const std::string& path, uint64_t hash, const SlrTable& table, const SlrCacheMeta& meta, std::string& error);
+
+// 映射并校验缓存文件，哈希、版本或数据不符时返回false并写入error
+bool loadSlrCache(const std::string& path, uint64_t hash, SlrTable& table, SlrCacheMeta& meta, std::string& error);
+
+#endif // SLRCACHE_H
@@ -0,0 +1,46 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 22:14:06
+ * @LastEditTime: 2026-10-19 23:41:18
+ * @FilePath: /LR_SLR/slrprogress.h
+ * @Description: 文法分析和语法分析的进度回调和取消
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#ifndef SLRPROGRESS_H
+#define SLRPROGRESS_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+// 进度阶段
+enum SlrProgressStage {
+    SLR_PROGRESS_FIRST, // First 集合
+    SLR_PROGRESS_FOLLOW, // Follow 集合
+    SLR_PROGRESS_AUTOMATON, // LR(0) 项目集规范族
+    SLR_PROGRESS_LOOKAHEAD, // LALR(1) 向前看集合
+    SLR_PROGRESS_TABLE, // 分析表和缓存
+    SLR_PROGRESS_PARSE, // 语法分析
+};
+
+/**
+ * 进度回调：(阶段, 已完成数, 当前总数)，阶段结束时 done == total
+ * 项目集规范族的已完成数是已扩展的状态数，总数是已发现的状态数，会随构建增长；
+ * 语法分析的已完成数是已读取记号的源文本末尾位置，总数是源文本长度
+ * 回调在分析所在的线程上调用，返回 false 时取消
+ */
+typedef std::function<bool(SlrProgressStage, size_t, size_t)> SlrProgress;
+
+// 分析被进度回调取消
+struct SlrCancelled : std::exception {
+    const char* what() const noexcept override {
+        return "grammar analysis cancelled";
+    }
+};
+
+// 汇报进度，回调要求取消时抛出 SlrCancelled
+inline void slrReportProgress(const SlrProgress& progress, SlrProgressStage stage, size_t done, size_t total) {
+    if (progress && !progress(stage, done, total)) throw SlrCancelled();
+}
+
+#endif // SLRPROGRESS_H
@@ -0,0 +1,92 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 20:31:44
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /LR_SLR/slrstats.cpp
+ * @Description: 文法分析和语法分析各阶段的耗时、计数和内存分配
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#include "slrstats.h"
+#include "memcount.h"
+#include <sstream>
+
+using namespace std;
+
+bool slrMemoryCounted() {
+    return memoryCounted();
+}
+
+SlrStageTimer::SlrStageTimer(SlrStage* stage) : stage(stage) {
+    if (!stage) return;
+    if (slrMemoryCounted()) {
+        MemoryCounters counters = memoryCounters();
+        allocated = counters.allocated;
+        allocations = counters.allocations;
+        live = counters.live;
+        // 峰值从阶段开始时重新记录
+        resetMemoryPeak();
+    }
+    begin = chrono::steady_clock::now();
+}
+
+void SlrStageTimer::stop() {
+    if (!stage) return;
+    stage->ms += chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    stage->runs++;
+    if (slrMemoryCounted()) {
+        MemoryCounters counters = memoryCounters();
+        stage->allocated += counters.allocated - allocated;
+        stage->allocations += counters.allocations - allocations;
+        stage->retained += (long long)counters.live - (long long)live;
+        if (counters.peak > live && counters.peak - live > stage->peak) stage->peak = counters.peak - live;
+    }
+    stage = nullptr;
+}
+
+string SlrStats::toJson() const {
+    stringstream ss;
+    const pair<const char*, const SlrStage*> stages[] = {
+        { "grammar", &grammar },
+        { "first", &first },
+        { "follow", &follow },
+        { "automaton", &automaton },
+        { "lookahead", &lookahead },
+        { "table", &table },
+        { "cache", &cache },
+        { "parse", &parse },
+    };
+    bool memory = slrMemoryCounted();
+    ss << "{\"stages\":{";
+    bool begin = true;
+    for (auto& it : stages) {
+        if (!begin) ss << ',';
+        begin = false;
+        const SlrStage& stage = *it.second;
+        ss << '"' << it.first << "\":{\"ms\":" << stage.ms << ",\"runs\":" << stage.runs;
+        if (memory) {
+            ss << ",\"alloc_bytes\":" << stage.allocated
+                << ",\"allocs\":" << stage.allocations
+                << ",\"retained_bytes\":" << stage.retained
+                << ",\"peak_bytes\":" << stage.peak;
+        }
+        ss << '}';
+    }
+    ss << "},\"counters\":{"
+        << "\"first_components\":" << firstComponents
+        << ",\"follow_components\":" << followComponents
+        << ",\"closures\":" << closures
+        << ",\"item_set_comparisons\":" << itemSetComparisons
+        << ",\"states\":" << states
+        << ",\"items\":" << items
+        << ",\"transitions\":" << transitions
+        << ",\"cores\":" << cores
+        << ",\"merges\":" << merges
+        << ",\"shifts\":" << shifts
+        << ",\"reductions\":" << reductions
+        << ",\"stack_nodes\":" << stackNodes
+        << ",\"forest_nodes\":" << forestNodes
+        << ",\"ambiguities\":" << ambiguities
+        << "},\"cached\":" << (cached ? "true" : "false")
+        << ",\"memory\":" << (memory ? "true" : "false") << '}';
+    return ss.str();
+}
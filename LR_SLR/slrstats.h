@@ -0,0 +1,83 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 20:31:44
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /LR_SLR/slrstats.h
+ * @Description: 文法分析和语法分析各阶段的耗时、计数和内存分配
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#ifndef SLRSTATS_H
+#define SLRSTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// 单个阶段的统计，阶段可能执行多次（如多次 parse），数据累加
+// 内存数据只在程序链接了计数分配器（common/memhook.cpp，命令行工具和基准测试）时记录，计数为全进程范围
+struct SlrStage {
+    double ms = 0; // 累计耗时（毫秒）
+    size_t runs = 0; // 执行次数
+    size_t allocated = 0; // 阶段内分配的字节数
+    size_t allocations = 0; // 阶段内分配次数
+    long long retained = 0; // 阶段结束时仍存活的新增字节数，阶段释放了之前的内存时为负
+    size_t peak = 0; // 阶段内存活字节数相对阶段开始时的最大增量
+};
+
+// 文法文本 -> First -> Follow -> LR(0) DFA -> 向前看集合 -> 分析表 -> 解析 各阶段的统计
+struct SlrStats {
+    SlrStage grammar; // 读取文法文本、符号编号
+    SlrStage first; // First 集合
+    SlrStage follow; // Follow 集合
+    SlrStage automaton; // 项目集规范族（LR(1) 模式下含向前看集合）
+    SlrStage lookahead; // 规约项目的向前看集合（LALR(1)）和规约动作
+    SlrStage table; // 生成分析表
+    SlrStage cache; // 读写缓存文件
+    SlrStage parse; // 语法分析
+
+    size_t firstComponents = 0; // First 集合依赖图的强连通分量数
+    size_t followComponents = 0; // Follow 集合依赖图的强连通分量数
+    size_t closures = 0; // 项目集闭包计算次数
+    size_t itemSetComparisons = 0; // 按核心项目签名查找已有状态的次数
+    size_t states = 0; // DFA 状态数
+    size_t items = 0; // 全部状态的项目数之和
+    size_t transitions = 0; // LALR(1) 中非终结符号转移数，即 DeRemer-Pennello 关系的节点数
+    size_t cores = 0; // LR(1) 中不同的核心数，即 SLR(1) 的状态数
+    size_t merges = 0; // LR(1) 中与已有的同核心状态合并的次数
+    size_t shifts = 0; // 累计移进次数
+    size_t reductions = 0; // 累计规约次数
+    size_t stackNodes = 0; // GLR 分析累计的图结构栈节点数
+    size_t forestNodes = 0; // GLR 分析累计的分析森林符号节点数
+    size_t ambiguities = 0; // GLR 分析累计的有多种推导的节点数，见 ParsedResult::ambiguities
+    bool cached = false; // 分析表是否来自缓存
+
+    // 以 JSON 对象输出：{"stages":{...},"counters":{...},"cached":...}，记录了内存时阶段带有内存字段
+    std::string toJson() const;
+};
+
+// 是否链接了计数分配器，计数见 common/memcount.h
+bool slrMemoryCounted();
+
+// 阶段计时器：析构或 stop 时把经过的时间和内存分配累加到阶段上，stage 为空时不计时
+// 阶段之间不能嵌套，否则外层阶段的峰值会被内层重置
+class SlrStageTimer {
+private:
+    SlrStage* stage;
+    std::chrono::steady_clock::time_point begin;
+    size_t allocated = 0; // 开始时的计数
+    size_t allocations = 0;
+    size_t live = 0;
+
+public:
+    explicit SlrStageTimer(SlrStage* stage);
+    ~SlrStageTimer() {
+        stop();
+    }
+    SlrStageTimer(const SlrStageTimer&) = delete;
+    SlrStageTimer& operator=(const SlrStageTimer&) = delete;
+
+    // 提前结束计时，之后不再累加
+    void stop();
+};
+
+#endif // SLRSTATS_H
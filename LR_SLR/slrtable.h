@@ -0,0 +1,93 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 17:48:02
+ * @LastEditTime: 2026-10-19 23:58:44
+ * @FilePath: /LR_SLR/slrtable.h
+ * @Description: 扁平的 SLR 分析表（ACTION/GOTO、产生式、语义动作），可由文法生成或从缓存文件映射
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#ifndef SLRTABLE_H
+#define SLRTABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <string>
+
+// ACTION 表项编码：低两位为动作类型，其余位为移进目标状态或产生式编号
+#define SLR_ERROR 0 // 无动作
+#define SLR_SHIFT 1 // 移进
+#define SLR_REDUCE 2 // 规约
+#define SLR_ACCEPT 3 // 规约到起始符号后接受
+#define SLR_ENTRY(type, value) ((int32_t)(((value) << 2) | (type)))
+#define SLR_TYPE(entry) ((entry) & 3)
+#define SLR_VALUE(entry) ((entry) >> 2)
+
+// 分析表的构造方法：前两种在 LR(0) 项目集规范族上生成，只是规约项目的向前看集合不同
+enum SlrTableMode {
+    SLR_MODE_SLR = 0, // SLR(1)：向前看集合为规约项目左部的 Follow 集合
+    SLR_MODE_LALR = 1, // LALR(1)：按 DeRemer-Pennello 关系求出每个状态中规约项目的向前看集合
+    SLR_MODE_LR1 = 2, // LR(1)：项目带向前看集合构造，同核心的状态弱相容（Pager）时才合并，状态数可能多于前两者
+};
+
+// 构造方法的名称，如 "SLR(1)"
+inline const char* slrTableModeName(SlrTableMode mode) {
+    return mode == SLR_MODE_LR1 ? "LR(1)" : mode == SLR_MODE_LALR ? "LALR(1)" : "SLR(1)";
+}
+
+// 产生式
+struct SlrProduction {
+    int32_t key; // 左部非终结符号编号
+    int32_t length; // 右部去掉 EPSILON 后的长度，即规约时出栈数
+    int32_t treeBegin; // 语义动作区间 [treeBegin, treeEnd)，下标指向 SlrTable::tree
+    int32_t treeEnd;
+};
+
+// 语义动作：右部第 index 个符号的节点作为树根（-1）或第 value 个孩子
+struct SlrTreeAction {
+    int32_t index;
+    int32_t value;
+};
+
+// 有冲突的表项中没有写入 action 的其余动作，GLR 分析时与 action 中的动作一起执行
+struct SlrConflict {
+    int32_t cell; // state * terminalCount + terminal
+    int32_t action; // 编码同 SlrTable::action
+};
+
+// LR 分析表（SLR(1)、LALR(1) 或 LR(1)），数据由 storage 持有（内存中的数组或映射的缓存文件）
+struct SlrTable {
+    int stateCount = 0;
+    int terminalCount = 0; // 终结符号（含结束符）数量，编号同 Grammer::terminalId
+    int nonterminalCount = 0; // 非终结符号数量，按名称排序编号
+    int productionCount = 0;
+    int treeCount = 0; // 语义动作数量
+    int conflictCount = 0; // 冲突中未写入 action 的动作数量，无冲突时为0
+    const int32_t* action = nullptr; // [state * terminalCount + terminal] -> 编码后的动作
+    const int32_t* gotos = nullptr; // [state * nonterminalCount + nonterminal] -> 目标状态，-1 为无转移
+    const SlrProduction* productions = nullptr;
+    const SlrTreeAction* tree = nullptr; // 每个产生式的语义动作按 index 从大到小排列
+    const SlrConflict* conflicts = nullptr; // 按 cell 升序排列
+    std::shared_ptr<const void> storage;
+
+    int32_t actionOf(int state, int terminal) const {
+        return action[(size_t)state * terminalCount + terminal];
+    }
+
+    int32_t gotoOf(int state, int nonterminal) const {
+        return gotos[(size_t)state * nonterminalCount + nonterminal];
+    }
+
+    // (state, terminal) 上除 actionOf 以外的动作区间 [first, second)
+    std::pair<const SlrConflict*, const SlrConflict*> conflictsOf(int state, int terminal) const {
+        int32_t cell = (int32_t)((size_t)state * terminalCount + terminal);
+        const SlrConflict* first = std::lower_bound(conflicts, conflicts + conflictCount, cell,
+            [](const SlrConflict& conflict, int32_t cell) { return conflict.cell < cell; });
+        const SlrConflict* last = first;
+        while (last != conflicts + conflictCount && last->cell == cell) last++;
+        return { first, last };
+    }
+};
+
+#endif // SLRTABLE_H
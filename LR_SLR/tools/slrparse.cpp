@@ -0,0 +1,187 @@
+/*
+ * @Author: 20212131001 翁行
+ * @Date: 2026-10-19 13:05:32
+ * @LastEditTime: 2026-10-19 23:59:26
+ * @FilePath: /LR_SLR/tools/slrparse.cpp
+ * @Description: 命令行版 LR_SLR：读取文法并批量解析 LEX 文件，无需图形界面
+ * Copyright (c) 2024 by wengx00, All Rights Reserved.
+ */
+#include "grammer.h"
+#include "toolutil.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void usage() {
+    cerr <<
+        "Usage: slrparse [-t] [-r] [-g] [--json] [-m slr|lalr|lr1] [-c <cache dir>] <grammar.txt> <input.lex>...\n"
+        "  -t         print the syntax tree of every accepted input\n"
+        "  -r         print every shift/reduce step and the symbols on the stack after it\n"
+        "  -g         parse with GLR, forking at table conflicts; -t prints the first derivation\n"
+        "             of an ambiguous input and -r is ignored\n"
+        "  --json     print the results, with per-stage timings and counters, as one JSON document\n"
+        "  -m <mode>  build SLR(1) (default), LALR(1) or LR(1) parse tables; LR(1) merges\n"
+        "             same-core states only when that adds no conflicts (Pager)\n"
+        "  -c <dir>   reuse parse tables cached in <dir>, caching new ones there\n"
+        "Exit status: 0 if every input is accepted, 1 if any is rejected,\n"
+        "2 on usage or grammar errors.\n";
+}
+
+// 解析 -m 的参数
+static bool parseMode(const string& name, SlrTableMode& mode) {
+    if (name == "slr") mode = SLR_MODE_SLR;
+    else if (name == "lalr") mode = SLR_MODE_LALR;
+    else if (name == "lr1") mode = SLR_MODE_LR1;
+    else return false;
+    return true;
+}
+
+// 以缩进文本输出语法树
+static void printTree(ostream& os, TreeNode* tree, int depth) {
+    if (!tree) return;
+    os << string(depth * 2, ' ') << tree->label;
+    if (tree->value.size()) os << " : " << tree->value;
+    os << '\n';
+    for (TreeNode* child : tree->children) printTree(os, child, depth + 1);
+}
+
+// 以JSON输出语法树
+static void printJsonTree(ostream& os, TreeNode* tree) {
+    if (!tree) {
+        os << "null";
+        return;
+    }
+    os << "{\"label\":" << quote(tree->label);
+    if (tree->value.size()) os << ",\"value\":" << quote(tree->value);
+    os << ",\"children\":[";
+    for (size_t i = 0; i < tree->children.size(); ++i) {
+        if (i) os << ',';
+        printJsonTree(os, tree->children[i]);
+    }
+    os << "]}";
+}
+
+int main(int argc, char* argv[]) {
+    bool withTree = false;
+    bool withTrace = false;
+    bool glr = false;
+    bool json = false;
+    SlrTableMode mode = SLR_MODE_SLR;
+    string cacheDir;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-t") withTree = true;
+        else if (arg == "-r") withTrace = true;
+        else if (arg == "-g") glr = true;
+        else if (arg == "--json") json = true;
+        else if (arg == "-c" && i + 1 < argc) cacheDir = argv[++i];
+        else if (arg == "-m" && i + 1 < argc && parseMode(argv[i + 1], mode)) i++;
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            usage();
+            return 2;
+        }
+        else paths.push_back(arg);
+    }
+    if (paths.size() < 2) {
+        usage();
+        return 2;
+    }
+
+    string text;
+    if (!readFile(paths[0], text)) {
+        cerr << paths[0] << ": cannot open file\n";
+        return 2;
+    }
+    auto begin = chrono::steady_clock::now();
+    Grammer grammer(text, cacheDir, nullptr, mode);
+    double buildTime = elapsed(begin);
+    if (grammer.bad()) {
+        cerr << paths[0] << ": " << grammer.getError() << '\n';
+        return 2;
+    }
+    if (!grammer.slr()) {
+        cerr << paths[0] << ": warning: grammar is not " << slrTableModeName(mode) << "\n" << grammer.getReason();
+    }
+
+    if (json) {
+        cout << "{\"grammar\":" << quote(paths[0])
+            << ",\"mode\":" << quote(mode == SLR_MODE_LR1 ? "lr1" : mode == SLR_MODE_LALR ? "lalr" : "slr")
+            << ",\"slr\":" << (grammer.slr() ? "true" : "false")
+            << ",\"glr\":" << (glr ? "true" : "false")
+            << ",\"states\":" << grammer.getTable().stateCount
+            << ",\"cached\":" << (grammer.fromCache() ? "true" : "false")
+            << ",\"build_ms\":" << buildTime
+            << ",\"inputs\":[";
+    }
+    else {
+        cout << paths[0] << ": " << grammer.getTable().stateCount << " states";
+        // LR(1) 的状态数与 SLR(1) 的状态数（不同的核心数）对比
+        if (mode == SLR_MODE_LR1 && !grammer.fromCache()) cout << " (" << grammer.getStats().cores << " SLR(1) states)";
+        cout << ", " << (grammer.fromCache() ? "loaded" : "built") << " in " << buildTime << " ms\n";
+    }
+
+    int rejected = 0;
+    for (size_t i = 1; i < paths.size(); ++i) {
+        const string& path = paths[i];
+        string input;
+        ParsedResult result;
+        double parseTime = 0;
+        if (!readFile(path, input)) {
+            result.error = "cannot open file";
+        }
+        else {
+            begin = chrono::steady_clock::now();
+            result = glr ? grammer.parseGlr(input) : grammer.parse(input, nullptr, withTrace);
+            parseTime = elapsed(begin);
+        }
+        bool accept = result.accept && result.error.empty();
+        if (!accept) rejected++;
+
+        if (json) {
+            if (i > 1) cout << ',';
+            cout << "{\"path\":" << quote(path)
+                << ",\"accept\":" << (accept ? "true" : "false")
+                << ",\"parse_ms\":" << parseTime
+                << ",\"shifts\":" << result.shifts
+                << ",\"reductions\":" << result.reductions;
+            if (glr) cout << ",\"ambiguities\":" << result.ambiguities;
+            if (result.error.size()) cout << ",\"error\":" << quote(result.error);
+            if (withTree && accept) {
+                cout << ",\"tree\":";
+                printJsonTree(cout, result.root);
+            }
+            if (withTrace) {
+                cout << ",\"trace\":[";
+                for (size_t step = 0; step < result.trace.size(); ++step) {
+                    if (step) cout << ',';
+                    cout << "{\"route\":" << quote(result.trace.route(step))
+                        << ",\"output\":" << quote(result.trace.output(step)) << '}';
+                }
+                cout << ']';
+            }
+            cout << '}';
+        }
+        else {
+            cout << path << ": " << (accept ? "ACCEPT" : "REJECT") << " in " << parseTime << " ms";
+            if (result.error.size()) cout << " (" << result.error << ')';
+            if (result.ambiguities) cout << " (ambiguous: " << result.ambiguities << " forest nodes have several derivations)";
+            cout << '\n';
+            for (size_t step = 0; step < result.trace.size(); ++step) {
+                cout << "  " << result.trace.route(step) << "\t" << result.trace.output(step) << '\n';
+            }
+            if (withTree && accept) printTree(cout, result.root, 1);
+        }
+        freeTree(result.root);
+    }
+    // 各阶段统计放在最后，parse 阶段为全部输入的累计
+    if (json) cout << "],\"stats\":" << grammer.getStats().toJson() << "}\n";
+    return rejected ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 21:52:14
+ * @LastEditTime: 2026-10-19 21:52:14
+ * @FilePath: /XLEX/automatonmodel.cpp
+ * @Description: NFA、DFA、MDFA 状态表的数据模型，只在单元格可见时才读取自动机生成文本
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "automatonmodel.h"
+#include <QFont>
+#include <QHeaderView>
+
+AutomatonTableModel::AutomatonTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+int AutomatonTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : stateCount;
+}
+
+int AutomatonTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : (int)symbols.size() + 1;
+}
+
+QVariant AutomatonTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) return QVariant();
+    int state = index.row();
+    if (index.column() == 0) {
+        if (role == Qt::DisplayRole) return state;
+        if (role == Qt::FontRole && isEnd(state)) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        if (role == Qt::ToolTipRole && isEnd(state)) return QString("终结状态");
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole) return QVariant();
+    QString target = transfer(state, symbols[index.column() - 1]);
+    if (target.isEmpty()) return QVariant();
+    return target;
+}
+
+QVariant AutomatonTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    if (section == 0) return QString("状态");
+    char symbol = symbols[section - 1];
+    if (symbol == EPSILON) return QString("EPSILON");
+    return QString(1, symbol);
+}
+
+NfaTableModel::NfaTableModel(Nfa& nfa, QObject* parent) : AutomatonTableModel(parent) {
+    NfaGraph graph = nfa.getGraph();
+    stateCount = graph.end->state + 1;
+    nodes.resize(stateCount);
+    // 子图编号连续，按编号收集所有节点
+    std::vector<NfaNode*> prepared(1, graph.start);
+    while (prepared.size()) {
+        NfaNode* cur = prepared.back();
+        prepared.pop_back();
+        if (nodes[cur->state]) continue;
+        nodes[cur->state] = cur;
+        for (auto& p : cur->transfers)
+            for (NfaNode* next : p.second)
+                prepared.push_back(next);
+    }
+    std::set<char> symbolSet = nfa.getSymbols();
+    symbolSet.insert(EPSILON);
+    symbols.assign(symbolSet.begin(), symbolSet.end());
+}
+
+QString NfaTableModel::transfer(int state, char symbol) const {
+    if (!nodes[state]) return QString();
+    auto it = nodes[state]->transfers.find(symbol);
+    if (it == nodes[state]->transfers.end()) return QString();
+    QString target;
+    for (NfaNode* next : it->second) {
+        if (target.size()) target += ", ";
+        target += QString::number(next->state);
+    }
+    return target;
+}
+
+bool NfaTableModel::isEnd(int state) const {
+    return nodes[state] && nodes[state]->isEnd;
+}
+
+DfaTableModel::DfaTableModel(Dfa& dfa, const std::set<char>& symbols, QObject* parent)
+    : AutomatonTableModel(parent), nodes(dfa.getNodes()) {
+    stateCount = nodes.size();
+    this->symbols.assign(symbols.begin(), symbols.end());
+}
+
+QString DfaTableModel::transfer(int state, char symbol) const {
+    auto it = nodes[state]->transfers.find(symbol);
+    if (it == nodes[state]->transfers.end()) return QString();
+    return QString::number(it->second);
+}
+
+bool DfaTableModel::isEnd(int state) const {
+    return nodes[state]->isEnd;
+}
+
+ScanTableModel::ScanTableModel(const ScanTable& table, QObject* parent) : AutomatonTableModel(parent), table(table) {
+    stateCount = table.stateCount;
+    symbols.assign(table.symbols.begin(), table.symbols.end());
+}
+
+QString ScanTableModel::transfer(int state, char symbol) const {
+    // 转移表中已合并任意字符转移，和它相同的显式转移不单独显示
+    int any = table.anyTarget(state);
+    int target = symbol == ANY ? any : table.next(state, symbol);
+    if (target < 0 || (symbol != ANY && target == any)) return QString();
+    return QString::number(target);
+}
+
+bool ScanTableModel::isEnd(int state) const {
+    return table.flags[state] & SCAN_ACCEPT;
+}
+
+void setupAutomatonView(QTableView* view, AutomatonTableModel* model) {
+    QAbstractItemModel* old = view->model();
+    view->setModel(model);
+    // 替换掉之前设置的状态表模型（如重新构建DFA）
+    if (qobject_cast<AutomatonTableModel*>(old)) old->deleteLater();
+    view->setWordWrap(false);
+    view->verticalHeader()->setVisible(false);
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->verticalHeader()->setDefaultSectionSize(view->fontMetrics().height() + 6);
+    view->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+}
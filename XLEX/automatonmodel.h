@@ -0,0 +1,86 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 21:52:14
+ * @LastEditTime: 2026-10-19 21:52:14
+ * @FilePath: /XLEX/automatonmodel.h
+ * @Description: NFA、DFA、MDFA 状态表的数据模型，只在单元格可见时才读取自动机生成文本
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef AUTOMATONMODEL_H
+#define AUTOMATONMODEL_H
+
+#include <QAbstractTableModel>
+#include <QTableView>
+#include "lexer.h"
+#include <vector>
+
+// 状态表公共部分：第0列为状态编号，其余每列一个转移字符，终结状态的编号加粗
+class AutomatonTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    explicit AutomatonTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    int stateCount = 0;
+    std::vector<char> symbols; // 各列的转移字符
+
+    // 状态state在symbol上的转移目标文本，无转移时为空
+    virtual QString transfer(int state, char symbol) const = 0;
+    virtual bool isEnd(int state) const = 0;
+};
+
+// NFA：节点按编号索引，目标可能有多个
+class NfaTableModel : public AutomatonTableModel {
+    Q_OBJECT
+
+public:
+    explicit NfaTableModel(Nfa& nfa, QObject* parent = nullptr);
+
+protected:
+    QString transfer(int state, char symbol) const override;
+    bool isEnd(int state) const override;
+
+private:
+    std::vector<NfaNode*> nodes; // 编号 -> 节点
+};
+
+// DFA：直接读取节点列表
+class DfaTableModel : public AutomatonTableModel {
+    Q_OBJECT
+
+public:
+    DfaTableModel(Dfa& dfa, const std::set<char>& symbols, QObject* parent = nullptr);
+
+protected:
+    QString transfer(int state, char symbol) const override;
+    bool isEnd(int state) const override;
+
+private:
+    std::vector<DfaNode*> nodes;
+};
+
+// 最小化DFA：读取扁平转移表，命中缓存时无需构建自动机
+class ScanTableModel : public AutomatonTableModel {
+    Q_OBJECT
+
+public:
+    explicit ScanTableModel(const ScanTable& table, QObject* parent = nullptr);
+
+protected:
+    QString transfer(int state, char symbol) const override;
+    bool isEnd(int state) const override;
+
+private:
+    ScanTable table; // 与 Lexer 共享数据
+};
+
+// 状态表视图的通用设置：固定行高、列宽可调，行数很多时也不需要逐行测量
+void setupAutomatonView(QTableView* view, AutomatonTableModel* model);
+
+#endif // AUTOMATONMODEL_H
@@ -0,0 +1,375 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 19:02:44
+ * @LastEditTime: 2026-10-19 23:59:26
+ * @FilePath: /XLEX/bench/xlexbench.cpp
+ * @Description: 自动机构建基准测试：按规模族生成正则，统计各阶段耗时、内存分配和状态数，输出 JSON
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexer.h"
+#include "toolutil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef XLEX_TEST_DIR
+#define XLEX_TEST_DIR "test"
+#endif
+
+static void usage() {
+    std::cerr <<
+        "Usage: xlexbench [-f <family>]... [-n <size,size,...>] [-r <repeat>] [-o <result.json>] [-s <spec.yaml>]...\n"
+        "  -f <family>   keywords | blowup | literal | spec (default: all)\n"
+        "                keywords: union of <size> distinct keywords\n"
+        "                blowup:   (a|b)*a(a|b){<size>}, DFA grows as 2^(size+1)\n"
+        "                literal:  concatenation of <size> literal characters\n"
+        "                spec:     YAML specs with <size> extra generated operators\n"
+        "  -n <sizes>    comma separated sizes, overriding each family's defaults\n"
+        "  -r <repeat>   build every case <repeat> times and keep the fastest (default 1)\n"
+        "  -o <file>     write the JSON result to <file> instead of stdout\n"
+        "  -s <spec>     spec family input (default: minic.yaml and bnf.yaml in the XLEX test dir)\n"
+        "Every case runs in its own process so that peak_rss_kb belongs to that case alone.\n";
+}
+
+// 单个测试用例
+struct BenchCase {
+    std::string family;
+    std::string name; // 用例名，spec 族为规则文件名
+    int size = 0;
+    std::string regex;
+    std::string error;
+};
+
+// 单个测试用例的结果
+struct BenchResult {
+    int nfaStates = 0;
+    int dfaStates = 0;
+    int mdfaStates = 0;
+    int classes = 0;
+    double nfaTime = 0;
+    double dfaTime = 0;
+    double mdfaTime = 0;
+    double tableTime = 0;
+    LexStats stats; // 各阶段的计数和内存分配
+};
+
+// 固定种子的伪随机数，保证每次生成的用例相同
+static unsigned nextRandom(unsigned& seed) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7fff;
+}
+
+// N 个互不相同的关键字的并
+static std::string keywordsRegex(int size) {
+    std::vector<std::string> words;
+    unsigned seed = 2024;
+    std::string regex;
+    while ((int)words.size() < size) {
+        std::string word;
+        int length = 3 + nextRandom(seed) % 6;
+        for (int i = 0; i < length; ++i) word += (char)('a' + nextRandom(seed) % 26);
+        bool exist = false;
+        for (auto& it : words) exist = exist || it == word;
+        if (exist) continue;
+        words.push_back(word);
+        if (regex.size()) regex += "|";
+        regex += word;
+    }
+    return regex;
+}
+
+// (a|b)*a(a|b){n}：倒数第 n+1 个字符为 a，DFA 需要记住最近 n+1 个字符
+static std::string blowupRegex(int size) {
+    std::string regex = "(a|b)*a";
+    for (int i = 0; i < size; ++i) regex += "(a|b)";
+    return regex;
+}
+
+// 长字面量连接
+static std::string literalRegex(int size) {
+    std::string regex;
+    for (int i = 0; i < size; ++i) regex += (char)('a' + i % 26);
+    return regex;
+}
+
+// 在规则文件的 OP 中追加 extra 个由运算符字符组成的新运算符
+static bool scaledSpecRegex(const std::string& path, int extra, std::string& regex, std::string& error) {
+    std::string text;
+    if (!readFile(path, text)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    YAML::Node doc;
+    try {
+        doc = YAML::Load(_replaceAll(text, " | ", "|"));
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    if (!checkLexSpec(doc, error)) return false;
+    // 按长度、字典序枚举运算符字符串，跳过已有的运算符
+    const std::string alphabet = "<>=!%-";
+    std::vector<std::string> existing;
+    for (auto it = doc["OP"].begin(); it != doc["OP"].end(); ++it) {
+        existing.push_back(it->second.as<std::string>());
+    }
+    std::vector<std::string> layer(1, "");
+    int added = 0;
+    while (added < extra) {
+        std::vector<std::string> next;
+        for (auto& prefix : layer) {
+            for (char c : alphabet) next.push_back(prefix + c);
+        }
+        for (auto& op : next) {
+            if (added >= extra) break;
+            bool exist = false;
+            for (auto& it : existing) exist = exist || it == op;
+            if (exist) continue;
+            doc["OP"]["bench_op_" + std::to_string(added++)] = op;
+        }
+        layer = next;
+    }
+    LexSpec spec;
+    try {
+        buildLexSpec(doc, spec);
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    regex = spec.regex;
+    return true;
+}
+
+// NFA -> DFA -> MDFA -> 转移表，分阶段计时
+static BenchResult runCase(const BenchCase& bench, int repeat) {
+    BenchResult best;
+    for (int i = 0; i < repeat; ++i) {
+        BenchResult result;
+        auto begin = std::chrono::steady_clock::now();
+        Nfa nfa(bench.regex, &result.stats);
+        result.nfaTime = elapsed(begin);
+        begin = std::chrono::steady_clock::now();
+        Dfa dfa(nfa, &result.stats);
+        result.dfaTime = elapsed(begin);
+        begin = std::chrono::steady_clock::now();
+        MDfa mdfa(dfa, &result.stats);
+        result.mdfaTime = elapsed(begin);
+        begin = std::chrono::steady_clock::now();
+        ScanTable table;
+        {
+            LexStageTimer timer(&result.stats.table);
+            table = ScanTable::build(mdfa, nfa.getSymbols());
+        }
+        result.tableTime = elapsed(begin);
+        result.nfaStates = nfa.getGraph().end->state + 1;
+        result.dfaStates = dfa.getNodes().size();
+        result.mdfaStates = table.stateCount;
+        result.classes = table.classCount;
+        double total = result.nfaTime + result.dfaTime + result.mdfaTime + result.tableTime;
+        double bestTotal = best.nfaTime + best.dfaTime + best.mdfaTime + best.tableTime;
+        if (i == 0 || total < bestTotal) best = result;
+    }
+    return best;
+}
+
+// 用例结果的 JSON 字段（不含峰值内存）
+static std::string resultJson(const BenchResult& result) {
+    std::stringstream ss;
+    ss << "\"nfa_states\":" << result.nfaStates
+        << ",\"dfa_states\":" << result.dfaStates
+        << ",\"mdfa_states\":" << result.mdfaStates
+        << ",\"classes\":" << result.classes
+        << ",\"nfa_ms\":" << result.nfaTime
+        << ",\"dfa_ms\":" << result.dfaTime
+        << ",\"mdfa_ms\":" << result.mdfaTime
+        << ",\"table_ms\":" << result.tableTime
+        << ",\"total_ms\":" << result.nfaTime + result.dfaTime + result.mdfaTime + result.tableTime
+        << ",\"stats\":" << result.stats.toJson();
+    return ss.str();
+}
+
+// 运行用例，返回 JSON 字段和峰值内存（KB，未知为-1）
+static bool runIsolated(const BenchCase& bench, int repeat, std::string& json, long& peak, std::string& error) {
+#ifdef _WIN32
+    // 没有 fork，只能在当前进程运行，峰值内存无法按用例区分
+    json = resultJson(runCase(bench, repeat));
+    peak = -1;
+    return true;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        error = "pipe failed";
+        return false;
+    }
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        error = "fork failed";
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        std::string out = resultJson(runCase(bench, repeat));
+        size_t written = 0;
+        while (written < out.size()) {
+            ssize_t n = write(fds[1], out.data() + written, out.size() - written);
+            if (n <= 0) break;
+            written += n;
+        }
+        close(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    json.clear();
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) json.append(buf, n);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty()) {
+        error = "case crashed";
+        return false;
+    }
+#ifdef __APPLE__
+    peak = usage.ru_maxrss / 1024; // macOS 上单位为字节
+#else
+    peak = usage.ru_maxrss;
+#endif
+    return true;
+#endif
+}
+
+// 解析逗号分隔的规模
+static bool parseSizes(const std::string& text, std::vector<int>& sizes) {
+    std::stringstream ss(text);
+    std::string item;
+    sizes.clear();
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        long size = strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end || size < 0) return false;
+        sizes.push_back(size);
+    }
+    return sizes.size() > 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> families;
+    std::vector<int> sizes;
+    std::vector<std::string> specs;
+    std::string output;
+    int repeat = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-f" && i + 1 < argc) families.push_back(argv[++i]);
+        else if (arg == "-n" && i + 1 < argc) {
+            if (!parseSizes(argv[++i], sizes)) {
+                usage();
+                return 2;
+            }
+        }
+        else if (arg == "-r" && i + 1 < argc) repeat = std::max(1, atoi(argv[++i]));
+        else if (arg == "-o" && i + 1 < argc) output = argv[++i];
+        else if (arg == "-s" && i + 1 < argc) specs.push_back(argv[++i]);
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (families.empty()) families = { "keywords", "blowup", "literal", "spec" };
+    if (specs.empty()) specs = { XLEX_TEST_DIR "/minic.yaml", XLEX_TEST_DIR "/bnf.yaml" };
+
+    // 生成用例
+    std::vector<BenchCase> cases;
+    for (const std::string& family : families) {
+        std::vector<int> familySizes = sizes;
+        if (family == "keywords") {
+            if (familySizes.empty()) familySizes = { 16, 64, 256 };
+            for (int size : familySizes) cases.push_back(BenchCase{ family, family, size, keywordsRegex(size), "" });
+        }
+        else if (family == "blowup") {
+            if (familySizes.empty()) familySizes = { 2, 4, 6, 8, 10 };
+            for (int size : familySizes) cases.push_back(BenchCase{ family, family, size, blowupRegex(size), "" });
+        }
+        else if (family == "literal") {
+            if (familySizes.empty()) familySizes = { 64, 256, 1024 };
+            for (int size : familySizes) cases.push_back(BenchCase{ family, family, size, literalRegex(size), "" });
+        }
+        else if (family == "spec") {
+            if (familySizes.empty()) familySizes = { 0, 16, 64 };
+            for (const std::string& spec : specs) {
+                std::string name = spec.substr(spec.find_last_of("/\\") + 1);
+                for (int size : familySizes) {
+                    BenchCase bench{ family, name, size, "", "" };
+                    scaledSpecRegex(spec, size, bench.regex, bench.error);
+                    cases.push_back(bench);
+                }
+            }
+        }
+        else {
+            std::cerr << "unknown family: " << family << '\n';
+            usage();
+            return 2;
+        }
+    }
+
+    std::ofstream file;
+    if (output.size()) {
+        file.open(output, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << output << ": cannot open output file\n";
+            return 2;
+        }
+    }
+    std::ostream& os = output.size() ? file : std::cout;
+    int failed = 0;
+    os << "{\"benchmark\":\"xlex-automata\",\"repeat\":" << repeat << ",\"results\":[";
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const BenchCase& bench = cases[i];
+        std::string json, error = bench.error;
+        long peak = -1;
+        std::cerr << bench.name << " " << bench.size << "...";
+        bool ok = error.empty() && runIsolated(bench, repeat, json, peak, error);
+        if (i) os << ',';
+        os << "\n{\"family\":" << quote(bench.family)
+            << ",\"name\":" << quote(bench.name)
+            << ",\"size\":" << bench.size
+            << ",\"regex_length\":" << bench.regex.size();
+        if (ok) {
+            os << ',' << json << ",\"peak_rss_kb\":";
+            if (peak < 0) os << "null";
+            else os << peak;
+            std::cerr << " ok\n";
+        }
+        else {
+            os << ",\"error\":" << quote(error);
+            std::cerr << " " << error << '\n';
+            failed++;
+        }
+        os << '}';
+        os.flush();
+    }
+    os << "\n]}\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,523 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 21:40:26
+ * @LastEditTime: 2026-10-19 23:59:53
+ * @FilePath: /XLEX/check/xlexcheck.cpp
+ * @Description: 差分检查：随机生成正则和输入，核对NFA模拟、DFA、MDFA、转移表、分词器和生成的分词程序结果一致
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexer.h"
+#include "nfasim.hpp"
+#include "scanner.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+static void usage() {
+    std::cerr <<
+        "Usage: xlexcheck [-n <count>] [-i <inputs>] [-s <seed>] [-r <regex>]... [-c <c++ compiler>] [-g <count>] [-m <mismatches>]\n"
+        "  -n <count>       number of random regexes to check (default 500)\n"
+        "  -i <inputs>      random inputs per regex (default 40)\n"
+        "  -s <seed>        seed of the first regex, regex k uses seed + k (default 1)\n"
+        "  -r <regex>       check <regex> instead of random ones, may be repeated\n"
+        "  -c <compiler>    also compile the generated scanners with <compiler> and run them\n"
+        "  -g <count>       compile at most <count> generated scanners (default 20)\n"
+        "  -m <mismatches>  stop after <mismatches> mismatches (default 10)\n"
+        "The NFA simulator is the reference; every other engine must agree with it on whole-input\n"
+        "acceptance and on the token boundaries of the scanner loop. Exit status is 1 on any mismatch.\n";
+}
+
+// 固定种子的伪随机数，保证每次生成的用例相同
+static unsigned nextRandom(unsigned& seed) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7fff;
+}
+
+// 可见的转义显示，便于复现
+static std::string escape(const std::string& str) {
+    std::string ret = "\"";
+    for (unsigned char c : str) {
+        switch (c) {
+        case '"': ret += "\\\""; break;
+        case '\\': ret += "\\\\"; break;
+        case '\n': ret += "\\n"; break;
+        case '\t': ret += "\\t"; break;
+        default: ret += c;
+        }
+    }
+    return ret + "\"";
+}
+
+// 随机正则的语法树
+struct RegexTree {
+    char op; // 's' 字符，'[' 中括号，'.' 连接，'|' 或，'*' '+' '?' 闭包
+    std::string symbols; // 's' 和 '[' 的字符
+    std::vector<RegexTree> children;
+};
+
+// 正则中使用的普通字符，以及需要转译才能作为普通字符的运算符
+static const std::string LETTERS = "abc";
+static const std::string ESCAPED = "*(|";
+// 输入中额外出现的字符：不在正则里的字符和分隔符
+static const std::string NOISE = "xz \t\n";
+
+static RegexTree randomTree(unsigned& seed, int depth) {
+    RegexTree tree;
+    int pick = depth <= 0 ? nextRandom(seed) % 3 : nextRandom(seed) % 10;
+    if (pick == 0 || pick == 1) {
+        tree.op = 's';
+        unsigned kind = nextRandom(seed) % 12;
+        if (kind == 0) tree.symbols = ANY;
+        else if (kind == 1) tree.symbols = ESCAPED[nextRandom(seed) % ESCAPED.size()];
+        else tree.symbols = LETTERS[nextRandom(seed) % LETTERS.size()];
+        return tree;
+    }
+    if (pick == 2) {
+        tree.op = '[';
+        int count = 1 + nextRandom(seed) % 3;
+        for (int i = 0; i < count; ++i) {
+            tree.symbols += nextRandom(seed) % 8 ? LETTERS[nextRandom(seed) % LETTERS.size()] : ANY;
+        }
+        return tree;
+    }
+    if (pick <= 5) {
+        tree.op = pick == 3 ? '|' : '.';
+        int count = 2 + nextRandom(seed) % 2;
+        for (int i = 0; i < count; ++i) tree.children.push_back(randomTree(seed, depth - 1));
+        return tree;
+    }
+    tree.op = "*+??"[pick - 6];
+    tree.children.push_back(randomTree(seed, depth - 1));
+    return tree;
+}
+
+// 语法树 -> XLEX 正则文本
+static std::string render(const RegexTree& tree, char parent = '|') {
+    std::string ret;
+    switch (tree.op) {
+    case 's':
+        if (ESCAPED.find(tree.symbols[0]) != std::string::npos) ret += '\\';
+        return ret + tree.symbols;
+    case '[':
+        return "[" + tree.symbols + "]";
+    case '.':
+        for (auto& child : tree.children) ret += render(child, '.');
+        return parent == '.' || parent == '|' ? ret : "(" + ret + ")";
+    case '|':
+        for (auto& child : tree.children) ret += (ret.size() ? "|" : "") + render(child, '|');
+        return parent == '|' ? ret : "(" + ret + ")";
+    default:
+        return render(tree.children[0], tree.op) + tree.op;
+    }
+}
+
+// 任意字符转移能接受的一个字符（换行符除外）
+static char randomAny(unsigned& seed) {
+    static const std::string chars = "abcxz*(|~ \t";
+    return chars[nextRandom(seed) % chars.size()];
+}
+
+// 生成一个能被语法树匹配的字符串
+static void sample(const RegexTree& tree, unsigned& seed, std::string& out) {
+    switch (tree.op) {
+    case 's':
+    case '[': {
+        char c = tree.symbols[nextRandom(seed) % tree.symbols.size()];
+        out += c == ANY ? randomAny(seed) : c;
+        return;
+    }
+    case '.':
+        for (auto& child : tree.children) sample(child, seed, out);
+        return;
+    case '|':
+        sample(tree.children[nextRandom(seed) % tree.children.size()], seed, out);
+        return;
+    default: {
+        int low = tree.op == '+' ? 1 : 0;
+        int high = tree.op == '?' ? 1 : 3;
+        int count = low + nextRandom(seed) % (high - low + 1);
+        for (int i = 0; i < count; ++i) sample(tree.children[0], seed, out);
+    }
+    }
+}
+
+// 随机输入：若干匹配串以分隔符连接，再随机改动几个字符；也有完全随机的串
+static std::string randomInput(const RegexTree* tree, unsigned& seed) {
+    const std::string alphabet = LETTERS + ESCAPED + NOISE + ANY;
+    std::string input;
+    if (!tree || nextRandom(seed) % 4 == 0) {
+        int length = nextRandom(seed) % 12;
+        for (int i = 0; i < length; ++i) input += alphabet[nextRandom(seed) % alphabet.size()];
+        return input;
+    }
+    int parts = 1 + nextRandom(seed) % 4;
+    for (int i = 0; i < parts; ++i) {
+        if (i) {
+            unsigned kind = nextRandom(seed) % 4;
+            if (kind) input += NOISE[2 + nextRandom(seed) % 3];
+        }
+        sample(*tree, seed, input);
+    }
+    int mutations = nextRandom(seed) % 3 == 0 ? 1 + nextRandom(seed) % 2 : 0;
+    for (int i = 0; i < mutations; ++i) {
+        char c = alphabet[nextRandom(seed) % alphabet.size()];
+        size_t at = input.empty() ? 0 : nextRandom(seed) % input.size();
+        switch (nextRandom(seed) % 3) {
+        case 0: input.insert(input.begin() + at, c); break;
+        case 1: if (input.size()) input.erase(at, 1); break;
+        default: if (input.size()) input[at] = c;
+        }
+    }
+    return input;
+}
+
+// 分词结果：各分词的 [begin, end) 以及是否无错误地读完输入
+struct TokenResult {
+    std::vector<std::pair<size_t, size_t>> tokens;
+    bool ok = true;
+};
+
+// 比较两个分词结果，positions 为 false 时只比较分词文本（位置不可知的后端）
+static bool sameTokens(const TokenResult& a, const TokenResult& b, const std::string& input, bool positions) {
+    if (a.ok != b.ok || a.tokens.size() != b.tokens.size()) return false;
+    if (positions) return a.tokens == b.tokens;
+    for (size_t i = 0; i < a.tokens.size(); ++i) {
+        if (input.compare(a.tokens[i].first, a.tokens[i].second - a.tokens[i].first,
+            input, b.tokens[i].first, b.tokens[i].second - b.tokens[i].first)) return false;
+    }
+    return true;
+}
+
+static bool isBlank(char c) {
+    return c == '\n' || c == ' ' || c == '\t';
+}
+
+/**
+ * 与 Scanner::Cursor 和生成的分词程序相同的分词循环，Engine 需提供：
+ * int start()、int next(int state, char c)（-1 为无转移，已含任意字符转移）、
+ * bool accept(int state)、bool any(int state)（是否有任意字符转移）
+ */
+template <class Engine>
+static TokenResult tokenize(Engine& engine, const std::string& input) {
+    TokenResult result;
+    size_t pos = 0, size = input.size();
+    for (;;) {
+        int state = engine.start();
+        size_t begin = pos, length = 0;
+        bool emitted = false;
+        while (pos < size) {
+            char id = input[pos];
+            int next = engine.next(state, id);
+            if (next >= 0) {
+                if (length == 0) begin = pos;
+                state = next;
+                length++;
+                pos++;
+                continue;
+            }
+            if (engine.any(state)) {
+                pos++;
+                if (length > 0) {
+                    emitted = true;
+                    break;
+                }
+                state = engine.start();
+                continue;
+            }
+            if (engine.accept(state)) {
+                if (length > 0) {
+                    if (isBlank(id)) pos++;
+                    emitted = true;
+                    break;
+                }
+                pos++;
+                state = engine.start();
+                continue;
+            }
+            if (isBlank(id) && length == 0) {
+                pos++;
+                continue;
+            }
+            result.ok = false;
+            return result;
+        }
+        if (emitted) {
+            result.tokens.emplace_back(begin, begin + length);
+            continue;
+        }
+        if (length > 0) {
+            if (!engine.accept(state)) result.ok = false;
+            else result.tokens.emplace_back(begin, begin + length);
+        }
+        return result;
+    }
+}
+
+// 整个输入是否被接受
+template <class Engine>
+static bool accepts(Engine& engine, const std::string& input) {
+    int state = engine.start();
+    for (char c : input) {
+        state = engine.next(state, c);
+        if (state < 0) return false;
+    }
+    return engine.accept(state);
+}
+
+// 参考实现：NFA模拟，状态集合按出现顺序编号
+class NfaEngine {
+private:
+    const NfaSimulator& simulator;
+    std::vector<std::vector<int>> sets;
+    std::map<std::vector<int>, int> ids;
+
+    int idOf(const std::vector<int>& states) {
+        if (states.empty()) return -1;
+        auto it = ids.emplace(states, (int)sets.size());
+        if (it.second) sets.push_back(states);
+        return it.first->second;
+    }
+
+public:
+    explicit NfaEngine(const NfaSimulator& simulator) : simulator(simulator) {
+        idOf(simulator.start());
+    }
+    int start() { return 0; }
+    int next(int state, char c) { return idOf(simulator.step(sets[state], c)); }
+    bool accept(int state) { return simulator.isEnd(sets[state]); }
+    bool any(int state) { return simulator.hasAny(sets[state]); }
+};
+
+// DFA、MDFA 节点上的转移：显式转移优先，其次是任意字符转移（换行符除外）
+static int transferOf(const std::map<char, int>& transfers, char c) {
+    if (c != ANY) {
+        auto it = transfers.find(c);
+        if (it != transfers.end()) return it->second;
+    }
+    if (c != '\n') {
+        auto it = transfers.find(ANY);
+        if (it != transfers.end()) return it->second;
+    }
+    return -1;
+}
+
+class DfaEngine {
+private:
+    std::vector<DfaNode*> nodes;
+
+public:
+    explicit DfaEngine(Dfa& dfa) : nodes(dfa.getNodes()) {}
+    int start() { return 0; }
+    int next(int state, char c) { return transferOf(nodes[state]->transfers, c); }
+    bool accept(int state) { return nodes[state]->isEnd; }
+    bool any(int state) { return nodes[state]->transfers.count(ANY) > 0; }
+};
+
+class MDfaEngine {
+private:
+    std::vector<MDfaNode*> nodes;
+
+public:
+    explicit MDfaEngine(MDfa& mdfa) : nodes(mdfa.getNodes()) {}
+    int start() { return 0; }
+    int next(int state, char c) { return transferOf(nodes[state]->transfer, c); }
+    bool accept(int state) { return nodes[state]->isEnd; }
+    bool any(int state) { return nodes[state]->transfer.count(ANY) > 0; }
+};
+
+class TableEngine {
+private:
+    const ScanTable& table;
+
+public:
+    explicit TableEngine(const ScanTable& table) : table(table) {}
+    int start() { return 0; }
+    int next(int state, char c) { return table.next(state, c); }
+    bool accept(int state) { return table.flags[state] & SCAN_ACCEPT; }
+    bool any(int state) { return table.flags[state] & SCAN_ANY; }
+};
+
+// 参与比较的后端：整串接受判定（可为空）和分词
+struct CheckEngine {
+    std::string name;
+    std::function<bool(const std::string&)> accepts;
+    std::function<TokenResult(const std::string&)> tokenize;
+    bool positions = true; // 分词位置是否可靠，生成的分词程序只输出分词文本
+};
+
+static std::string describe(const TokenResult& result, const std::string& input) {
+    std::string ret;
+    for (auto& token : result.tokens) {
+        ret += (ret.size() ? " " : "") + escape(input.substr(token.first, token.second - token.first));
+    }
+    return "[" + ret + "]" + (result.ok ? "" : " error");
+}
+
+// 编译生成的分词程序，失败时返回空
+static std::string compileScanner(Lexer& lexer, const std::string& compiler, const std::filesystem::path& dir, int index) {
+    std::filesystem::path source = dir / ("scanner" + std::to_string(index) + ".cpp");
+    std::filesystem::path program = dir / ("scanner" + std::to_string(index));
+    {
+        std::ofstream ofs(source, std::ios::out | std::ios::binary);
+        if (!ofs.is_open()) return "";
+        lexer.generate(ofs);
+    }
+    std::string command = compiler + " -std=c++11 -O0 -o \"" + program.string() + "\" \"" + source.string() + "\"";
+    if (std::system(command.c_str()) != 0) return "";
+    return program.string();
+}
+
+// 运行生成的分词程序：输出文件每行为 "Label : 分词"，出错时最后一行为错误信息
+// 分词位置按顺序在输入中查找，只作显示用
+static TokenResult runScanner(const std::string& program, const std::filesystem::path& dir, const std::string& input) {
+    std::filesystem::path in = dir / "input.txt", out = dir / "output.txt";
+    {
+        std::ofstream ofs(in, std::ios::out | std::ios::binary);
+        ofs << input;
+    }
+    std::string command = "\"" + program + "\" \"" + in.string() + "\" \"" + out.string() + "\" > \"" + (dir / "stdout.txt").string() + "\"";
+    TokenResult result;
+    result.ok = std::system(command.c_str()) == 0;
+    std::ifstream ifs(out, std::ios::in | std::ios::binary);
+    std::string line;
+    size_t pos = 0;
+    while (std::getline(ifs, line)) {
+        size_t split = line.find(" : ");
+        if (split == std::string::npos) continue; // 错误信息
+        // 分词是连续的一段，按顺序在输入中定位
+        std::string token = line.substr(split + 3);
+        size_t begin = input.find(token, pos);
+        if (begin == std::string::npos) begin = input.size();
+        result.tokens.emplace_back(begin, begin + token.size());
+        pos = begin + token.size();
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int count = 500, inputs = 40, compileLimit = 20, mismatchLimit = 10;
+    unsigned seed = 1;
+    std::vector<std::string> regexes;
+    std::string compiler;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) count = std::max(0, atoi(argv[++i]));
+        else if (arg == "-i" && i + 1 < argc) inputs = std::max(1, atoi(argv[++i]));
+        else if (arg == "-s" && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-r" && i + 1 < argc) regexes.push_back(argv[++i]);
+        else if (arg == "-c" && i + 1 < argc) compiler = argv[++i];
+        else if (arg == "-g" && i + 1 < argc) compileLimit = std::max(0, atoi(argv[++i]));
+        else if (arg == "-m" && i + 1 < argc) mismatchLimit = std::max(1, atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (regexes.size()) count = regexes.size();
+    for (auto& regex : regexes) {
+        std::string error;
+        if (!Nfa::check(regex, error)) {
+            std::cerr << escape(regex) << ": " << error << '\n';
+            return 2;
+        }
+    }
+
+    std::filesystem::path dir;
+    if (compiler.size()) {
+        dir = std::filesystem::temp_directory_path() / ("xlexcheck-" + std::to_string(seed));
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+    }
+
+    int mismatches = 0, compiled = 0;
+    size_t checked = 0;
+    for (int k = 0; k < count && mismatches < mismatchLimit; ++k) {
+        unsigned caseSeed = seed + k;
+        unsigned random = caseSeed;
+        RegexTree tree;
+        std::string regex;
+        if (regexes.size()) regex = regexes[k];
+        else {
+            tree = randomTree(random, 1 + nextRandom(random) % 4);
+            regex = render(tree);
+        }
+
+        LexSpec spec;
+        spec.regex = regex;
+        Lexer lexer(spec);
+        NfaSimulator simulator(lexer.getNfa());
+        Scanner scanner(lexer);
+
+        // 参考实现放在第一个，之后的后端都和它比较；新的后端（惰性DFA、位并行等）在这里注册
+        std::vector<CheckEngine> engines;
+        engines.push_back({ "nfa",
+            [&](const std::string& input) { NfaEngine engine(simulator); return accepts(engine, input); },
+            [&](const std::string& input) { NfaEngine engine(simulator); return tokenize(engine, input); } });
+        engines.push_back({ "dfa",
+            [&](const std::string& input) { DfaEngine engine(lexer.getDfa()); return accepts(engine, input); },
+            [&](const std::string& input) { DfaEngine engine(lexer.getDfa()); return tokenize(engine, input); } });
+        engines.push_back({ "mdfa",
+            [&](const std::string& input) { MDfaEngine engine(lexer.getMDfa()); return accepts(engine, input); },
+            [&](const std::string& input) { MDfaEngine engine(lexer.getMDfa()); return tokenize(engine, input); } });
+        engines.push_back({ "table",
+            [&](const std::string& input) { TableEngine engine(lexer.getTable()); return accepts(engine, input); },
+            [&](const std::string& input) { TableEngine engine(lexer.getTable()); return tokenize(engine, input); } });
+        engines.push_back({ "scanner", nullptr,
+            [&](const std::string& input) {
+                TokenResult result;
+                Scanner::Cursor cursor = scanner.scan(input);
+                LexToken token;
+                while (cursor.next(token)) result.tokens.emplace_back(token.begin, token.end);
+                result.ok = cursor.getError().empty();
+                return result;
+            } });
+        if (compiler.size() && compiled < compileLimit) {
+            std::string program = compileScanner(lexer, compiler, dir, compiled++);
+            if (program.empty()) {
+                std::cerr << "case " << caseSeed << ": cannot compile the generated scanner of " << escape(regex) << '\n';
+                mismatches++;
+                continue;
+            }
+            engines.push_back({ "generated", nullptr,
+                [program, dir](const std::string& input) { return runScanner(program, dir, input); }, false });
+        }
+
+        for (int j = 0; j < inputs && mismatches < mismatchLimit; ++j) {
+            std::string input = randomInput(regexes.empty() ? &tree : nullptr, random);
+            checked++;
+            bool expected = engines[0].accepts(input);
+            TokenResult expectedTokens = engines[0].tokenize(input);
+            std::string report;
+            for (size_t e = 1; e < engines.size(); ++e) {
+                if (engines[e].accepts && engines[e].accepts(input) != expected) {
+                    report += "  " + engines[e].name + " accepts=" + (expected ? "false" : "true") + '\n';
+                }
+                TokenResult tokens = engines[e].tokenize(input);
+                if (!sameTokens(tokens, expectedTokens, input, engines[e].positions)) {
+                    report += "  " + engines[e].name + " tokens=" + describe(tokens, input) + '\n';
+                }
+            }
+            if (report.empty()) continue;
+            mismatches++;
+            std::cerr << "case " << caseSeed << " regex " << escape(regex) << " input " << escape(input) << '\n'
+                << "  nfa accepts=" << (expected ? "true" : "false") << " tokens=" << describe(expectedTokens, input) << '\n'
+                << report;
+        }
+    }
+
+    if (compiler.size()) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+    std::cerr << count << " regexes, " << checked << " inputs, " << mismatches << " mismatches\n";
+    return mismatches ? 1 : 0;
+}
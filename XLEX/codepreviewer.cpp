@@ -1,7 +1,7 @@
 /*
  * @Author: 翁行
  * @Date: 2024-05-09 23:13:07
- * @LastEditTime: 2024-05-23 22:59:17
+ * @LastEditTime: 2026-10-19 03:58:24
  * @FilePath: /XLEX/codepreviewer.cpp
  * @Description: 生成的代码预览窗口
  * Copyright 2024 (c) 翁行, All Rights Reserved.
@@ -11,30 +11,44 @@
 #include <QFileDialog>
 #include <QMessageBox>
 
-CodePreviewer::CodePreviewer(QString code, QWidget* parent) :
+// 预览最多加载的字节数
+#define PREVIEW_LIMIT (256 * 1024)
+
+CodePreviewer::CodePreviewer(QString path, QWidget* parent) :
     QDialog(parent),
-    code(code),
-    ui(new Ui::CodePreviewer) {
+    ui(new Ui::CodePreviewer),
+    path(path) {
     ui->setupUi(this);
-    ui->previewer->setPlainText(code);
+    // 只加载开头部分作为预览，完整代码保存时从文件复制
+    QFile file{ path };
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        ui->previewer->setPlainText("无法读取生成的代码");
+        return;
+    }
+    QString preview = QString::fromUtf8(file.read(PREVIEW_LIMIT));
+    if (file.size() > PREVIEW_LIMIT) {
+        preview += "\n\n// ... 预览已截断，完整代码共 " + QString::number(file.size()) + " 字节，请保存后查看\n";
+    }
+    file.close();
+    ui->previewer->setPlainText(preview);
 }
 
 CodePreviewer::~CodePreviewer() {
     delete ui;
+    QFile::remove(path);
 }
 
 // 保存生成的代码
 void CodePreviewer::on_saveCode_clicked() {
     QString filename = QFileDialog::getSaveFileName(this, "保存文件", ".", "C++源文件(*.cpp)");
-    QFile file{ filename };
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out{ &file };
-        out << code;
-        file.close();
+    if (filename.isEmpty())
+        return;
+    if (QFile::exists(filename))
+        QFile::remove(filename);
+    if (QFile::copy(path, filename)) {
         QMessageBox::information(this, "提示", "生成成功");
         return;
     }
 
     QMessageBox::information(this, "提示", "文件保存失败");
 }
-
@@ -16,7 +16,8 @@ class CodePreviewer : public QDialog {
     Q_OBJECT
 
 public:
-    explicit CodePreviewer(QString code, QWidget* parent = nullptr);
+    // path 为已生成代码所在的临时文件，窗口关闭时删除
+    explicit CodePreviewer(QString path, QWidget* parent = nullptr);
     ~CodePreviewer();
 
 private slots:
@@ -25,7 +26,7 @@ private slots:
 private:
     Ui::CodePreviewer* ui;
 
-    QString code;
+    QString path;
 };
 
 #endif // CODEPREVIEWER_H
@@ -0,0 +1,288 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 10:12:05
+ * @LastEditTime: 2026-10-19 23:59:10
+ * @FilePath: /XLEX/include/codegen.hpp
+ * @Description: 分词程序代码生成（流式写出）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _CODEGEN_HPP
+#define _CODEGEN_HPP
+
+#include "scantable.h"
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 代码生成进度回调：(已生成的状态数, 状态总数)
+typedef function<void(size_t, size_t)> CodeGenProgress;
+
+// 流式代码生成器：根据最小化DFA的扁平转移表按块写入输出流，不在内存中拼接整份代码
+class CodeGenerator {
+private:
+    // 缓冲区达到该大小后写出一次
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    // 每生成多少个状态汇报一次进度
+    static const size_t PROGRESS_STEP = 256;
+
+    const ScanTable& table;
+    const map<string, string>& reserved;
+    const map<string, string>& op;
+
+    ostream* os = nullptr;
+    string buffer;
+    size_t written = 0;
+
+    void put(const string& str) {
+        buffer += str;
+        if (buffer.size() >= CHUNK_SIZE) flush();
+    }
+
+    void flush() {
+        if (buffer.empty()) return;
+        os->write(buffer.data(), buffer.size());
+        written += buffer.size();
+        buffer.clear();
+    }
+
+    // 库文件、关键字表、工具方法
+    void emitPrologue() {
+        // 库文件
+        put(
+            "#include <iostream>\n"
+            "#include <string>\n"
+            "#include <cstring>\n"
+            "#include <vector>\n"
+            "#include <map>\n"
+            "#include <sstream>\n"
+            "#include <fstream>\n\n");
+        // namespace
+        put("using namespace std;\n\n");
+
+        // RESERVED 关键字
+        put("map<string, string> reserved = {\n");
+        for (auto& it : reserved) {
+            put("\t{\"" + it.first + "\", \"" + it.second + "\"},\n");
+        }
+        put("};\n");
+
+        // OP 运算符
+        put("map<string, string> op = {\n");
+        for (auto& it : op) {
+            put("\t{\"" + it.first + "\", \"" + it.second + "\"},\n");
+        }
+        put("};\n");
+
+        // 工具方法：是否数字Token
+        put(
+            "bool isNumber(string token) {\n"
+            "\tif (token.size() < 1) return false;\n"
+            "\tif (token[0] >= '0' && token[0] <= '9') return true;\n"
+            "\treturn false;\n"
+            "}\n");
+
+        // 工具方法：是否注释Token
+        put(
+            "bool isComment(string token) {\n"
+            "\tif (token.size() < 2) return false;\n"
+            "\tif (token[0] >= 'a' && token[0] <= 'z' || token[0] >= 'A' && token[0] <= 'Z') return false;\n"
+            "\treturn true;\n"
+            "}\n");
+
+        // 工具方法：string转小写
+        put(
+            "string toLowerCase(string token) {\n"
+            "\tstring ret = \"\";\n"
+            "\tfor (auto c : token) ret += tolower(c);\n"
+            "\treturn ret;\n"
+            "}\n");
+
+        // 处理Token的方法
+        put(
+            "void handleToken(string token, ofstream& os) {\n"
+            "\tif (token.size() == 0) return;\n"
+            "\tstring label;\n"
+            "\tif (reserved.count(token)) label = reserved[token];\n"
+            "\telse if (op.count(token)) label = op[token];\n"
+            "\telse if (isNumber(token)) label = \"NUMBER\";\n"
+            "\telse if (isComment(token)) label = \"COMMENT\";\n"
+            "\telse label = \"IDENTIFIER\";\n"
+            "\tcout << label << \" : \" << token << '\\n';\n"
+            "\tos << label << \" : \" << token << '\\n';\n"
+            "}\n");
+
+        // 主函数头
+        put("int main(int argc, char* argv[]) {\n");
+        // 入参校验
+        put(
+            "\tif (argc != 3) {\n"
+            "\t\t cout << \"Error: Invalid input. Require input file path on agrv[1] and output file path on agrv[2]. \" << '\\n';\n"
+            "\t\t return 1;\n"
+            "\t}\n");
+        // 源代码文件path
+        put("\tstring path = argv[1];\n");
+        // 输出文件path
+        put("\tstring outputPath = argv[2];\n");
+        // 打开文件
+        put(
+            "\tifstream ifs(path);\n"
+            "\tofstream os(outputPath);\n"
+            "\tif (!ifs || !ifs.is_open()) {\n"
+            "\t\tcout << \"Error: Cannot open input file. \" << '\\n';\n"
+            "\t\treturn 1;\n"
+            "\t}\n"
+            "\tif (!os || !os.is_open()) {\n"
+            "\t\tcout << \"Error: Cannot open output file. \" << '\\n';\n"
+            "\t\treturn 1;\n"
+            "\t}\n");
+        // 读取源代码
+        put(
+            "\tstringstream ss;\n"
+            "\tss << ifs.rdbuf();\n"
+            "\tstring code = ss.str();\n"
+            "\tstring token = \"\";\n"
+            "\tss.clear();\n"
+            "\tss.str(\"\");\n");
+        // 初始状态
+        put("\tint currentState = 0;\n");
+        // 循环遍历
+        put(
+            "\tfor (int i = 0; i < code.size(); ++i) {\n"
+            "\t\tchar id = code[i];\n"
+            "\t\tswitch(currentState) {\n");
+    }
+
+    // 字符常量，转义引号和反斜杠
+    static string charLiteral(char c) {
+        if (c == '\'' || c == '\\') return string("'\\") + c + "'";
+        return string("'") + c + "'";
+    }
+
+    // 单个MDFA状态的 case 分支
+    void emitState(int state) {
+        bool isEnd = table.flags[state] & SCAN_ACCEPT;
+        int32_t any = table.anyTarget(state);
+        put(
+            "\t\t\tcase " + to_string(state) + ":\n"
+            "\t\t\t\tswitch (id) {\n");
+        // 和任意字符转移目标相同的显式转移交给 default 分支处理，default 分支不含换行，换行仍单独生成
+        for (char symbol : table.symbols) {
+            if (symbol == ANY) continue;
+            int32_t target = table.next(state, symbol);
+            if (target < 0 || (target == any && symbol != '\n')) continue;
+            put(
+                "\t\t\t\t\tcase " + charLiteral(symbol) + ":\n"
+                "\t\t\t\t\t\tcurrentState = " + to_string(target) + ";\n"
+                "\t\t\t\t\t\ttoken += id;\n"
+                "\t\t\t\t\t\tbreak;\n");
+        }
+        if (any >= 0) {
+            put(
+                "\t\t\t\t\tdefault:\n"
+                "\t\t\t\t\tif (id == '\\n') {\n"
+                "\t\t\t\t\t\tif (token.size() > 0) {\n"
+                "\t\t\t\t\t\t\thandleToken(token, os);\n"
+                "\t\t\t\t\t\t\ttoken = \"\";\n"
+                "\t\t\t\t\t\t}\n"
+                "\t\t\t\t\t\tcurrentState = 0;\n"
+                "\t\t\t\t\t}\n"
+                "\t\t\t\t\telse {\n"
+                "\t\t\t\t\tcurrentState = " + to_string(any) + ";\n"
+                "\t\t\t\t\ttoken += id;\n"
+                "\t\t\t\t\t}\n"
+                "\t\t\t\t\tbreak;\n");
+        }
+        else if (isEnd) {
+            // 拿到一个分词，重新开始
+            put(
+                "\t\t\t\t\tdefault:\n"
+                "\t\t\t\t\t\tif (token.size() > 0) {\n"
+                "\t\t\t\t\t\t\thandleToken(token, os);\n"
+                "\t\t\t\t\t\t\ttoken = \"\";\n"
+                "\t\t\t\t\t\t\tif (id != '\\n' && id != ' ' && id != '\\t') {\n"
+                "\t\t\t\t\t\t\t\ti--;\n"
+                "\t\t\t\t\t\t\t}\n"
+                "\t\t\t\t\t\t}\n"
+                "\t\t\t\t\t\tcurrentState = 0;\n");
+        }
+        else {
+            // 其他情况为错误情形
+            put(
+                "\t\t\t\t\tdefault:\n"
+                "\t\t\t\t\tif (id == '\\n' || id == ' ' || id == '\\t') {\n"
+                "\t\t\t\t\t\tif (token.size() == 0) {\n"
+                "\t\t\t\t\t\t\tbreak;\n"
+                "\t\t\t\t\t\t}\n"
+                "\t\t\t\t\t}\n"
+                "\t\t\t\t\t\tos << \"Error: Invalid input character. \" << '\\n';\n"
+                "\t\t\t\t\t\tcout << \"Error: Invalid input character. \" << '\\n';\n"
+                "\t\t\t\t\t\treturn 1;\n");
+        }
+        put(
+            "\t\t\t\t}\n"
+            "\t\t\tbreak;\n");
+    }
+
+    // 收尾：根据最终状态取到最后的分词
+    void emitEpilogue() {
+        put(
+            "\t\t}\n"
+            "\t}\n");
+
+        // 读取完毕，根据最终状态取到最后的分词；没有未完成的分词时（如以空白结尾）直接结束
+        put(
+            "\tif (token.size() > 0) {\n"
+            "\t\tswitch(currentState) {\n");
+        for (int state = 0; state < table.stateCount; ++state) {
+            if (table.flags[state] & SCAN_ACCEPT) {
+                put("\t\t\tcase " + to_string(state) + ":\n");
+            }
+        }
+        put(
+            "\t\t\t\thandleToken(token, os);\n"
+            "\t\t\t\tbreak;\n");
+        // 其他情况为错误情形
+        put(
+            "\t\t\tdefault:\n"
+            "\t\t\t\tcout << \"Error: Invalid input. \" << '\\n';\n"
+            "\t\t\t\treturn 1;\n"
+            "\t\t}\n"
+            "\t}\n");
+        // 主函数尾
+        put(
+            "\tcout << \"Success.\" << '\\n';\n"
+            "\treturn 0;\n"
+            "}\n");
+    }
+
+public:
+    CodeGenerator(const ScanTable& table, const map<string, string>& reserved, const map<string, string>& op)
+        : table(table), reserved(reserved), op(op) {}
+
+    // 生成代码并写入os，返回写入的字节数
+    size_t emit(ostream& out, CodeGenProgress progress = nullptr) {
+        size_t total = table.stateCount;
+        os = &out;
+        written = 0;
+        buffer.clear();
+        buffer.reserve(CHUNK_SIZE + 1024);
+
+        emitPrologue();
+        for (size_t i = 0; i < total; ++i) {
+            emitState(i);
+            if (progress && (i + 1) % PROGRESS_STEP == 0) progress(i + 1, total);
+        }
+        emitEpilogue();
+        flush();
+        out.flush();
+        if (progress) progress(total, total);
+        os = nullptr;
+        return written;
+    }
+};
+
+#endif
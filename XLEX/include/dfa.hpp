@@ -1,7 +1,7 @@
 /*
  * @Author: 翁行
  * @Date: 2023-12-31 16:20:40
- * @LastEditTime: 2024-05-31 00:46:22
+ * @LastEditTime: 2026-10-19 22:03:45
  * @FilePath: /XLEX/include/dfa.hpp
  * @Description: NFA图转DFA图
  * Copyright 2024 (c) 翁行, All Rights Reserved.
@@ -11,6 +11,7 @@
 
 #include <iostream>
 #include "nfa.hpp"
+#include "lexprogress.h"
 #include <cstring>
 #include <string>
 #include <vector>
@@ -57,12 +58,14 @@ class Dfa {
 private:
     // 生成DFA图
     void generate() {
+        LexStageTimer timer(stats ? &stats->dfa : nullptr);
         NfaGraph nfaGraph = nfa.getGraph();
         set<char> symbols = nfa.getSymbols();
         DfaNode* start = new DfaNode();
         start->bindNfaNodes(epsilonClosure(nfaGraph.start)); // 将NFA节点列表绑定进DFA状态中
         nodes.push_back(start); // 加入初始节点
         for (int i = 0; i < nodes.size(); ++i) {
+            lexReportProgress(progress, LEX_BUILD_DFA, i, nodes.size());
             DfaNode* cur = nodes[i];
             for (char symbol : symbols) {
                 set<NfaNode*> nfaNodesOfSymbol;
@@ -76,7 +79,9 @@ private:
                 instance->bindNfaNodes(nfaNodesOfSymbol);
                 // 子集构造法
                 for (DfaNode* exist : nodes) {
+                    if (stats) stats->subsetComparisons++;
                     if (*exist == *instance) {
+                        delete instance;
                         instance = exist;
                         break;
                     }
@@ -88,12 +93,16 @@ private:
                 cur->transfers[symbol] = instance->state;
             }
         }
+        if (stats) stats->dfaStates = nodes.size();
     }
 
     // 以symbol步进
+    // 只读访问NFA节点（不用 operator[]），构建DFA时其他线程可以同时读取NFA
     set<NfaNode*> forward(NfaNode* source, char symbol) {
         set<NfaNode*> result;
-        for (NfaNode* next : source->transfers[symbol]) {
+        auto it = source->transfers.find(symbol);
+        if (it == source->transfers.end()) return result;
+        for (NfaNode* next : it->second) {
             result.insert(next);
             // 同时要加入其EPSILON闭包
             set<NfaNode*> closureOfNext = epsilonClosure(next);
@@ -104,6 +113,7 @@ private:
 
     // NFA节点的EPSILON闭包
     set<NfaNode*> epsilonClosure(NfaNode* source) {
+        if (stats) stats->closures++;
         set<NfaNode*> closure;
         stack<NfaNode*> prepared; // DFS栈
         map<int, int> visited;
@@ -114,7 +124,9 @@ private:
             if (visited[cur->state]) continue;
             closure.insert(cur);
             visited[cur->state] = 1;
-            for (NfaNode* next : cur->transfers[EPSILON])
+            auto it = cur->transfers.find(EPSILON);
+            if (it == cur->transfers.end()) continue;
+            for (NfaNode* next : it->second)
                 prepared.push(next);
         }
         return closure;
@@ -122,10 +134,30 @@ private:
 
     vector<DfaNode*> nodes;
     Nfa& nfa;
+    LexStats* stats; // 构建统计，可为空
+    LexBuildProgress progress; // 构建进度，可为空
+
+    void release() {
+        for (DfaNode* node : nodes) delete node;
+        nodes.clear();
+    }
 public:
-    Dfa(Nfa& nfa) : nfa(nfa) {
-        generate();
+    // progress 要求取消时释放已生成的节点并抛出 LexCancelled
+    Dfa(Nfa& nfa, LexStats* stats = nullptr, LexBuildProgress progress = nullptr) : nfa(nfa), stats(stats), progress(progress) {
+        try {
+            generate();
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+        this->progress = nullptr;
+    }
+    ~Dfa() {
+        release();
     }
+    Dfa(const Dfa&) = delete;
+    Dfa& operator=(const Dfa&) = delete;
     // 获取原始NFA
     Nfa getNfa() {
         return nfa;
@@ -0,0 +1,64 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 11:20:43
+ * @LastEditTime: 2026-10-19 22:03:45
+ * @FilePath: /XLEX/include/lexer.h
+ * @Description: 分词器构建 LexSpec -> NFA -> DFA -> MDFA -> 代码（不依赖 Qt）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _LEXER_H
+#define _LEXER_H
+
+#include "lexspec.h"
+#include "lexstats.h"
+#include "lexprogress.h"
+#include "nfa.hpp"
+#include "dfa.hpp"
+#include "mdfa.hpp"
+#include "scantable.h"
+#include "codegen.hpp"
+
+// 分词器 All in one
+class Lexer {
+private:
+    LexSpec spec;
+    Nfa* nfa = nullptr;
+    Dfa* dfa = nullptr;
+    MDfa* mdfa = nullptr;
+    ScanTable table;
+    bool cached = false;
+    LexStats stats;
+
+    std::string cachePath; // 缓存文件路径，为空时不使用缓存
+
+public:
+    // cacheDir 非空时先按规则哈希查找编译好的自动机，命中则不再构建 NFA/DFA/MDFA，未命中则构建后写入缓存
+    // stats 为此前阶段（如 loadLexSpec）的统计，之后的阶段在其基础上继续记录
+    // deferred 为 true 时只查找缓存，未命中时需调用 build 构建（如在后台线程上构建）
+    explicit Lexer(const LexSpec& spec, const std::string& cacheDir = "", const LexStats& stats = LexStats(), bool deferred = false);
+    ~Lexer();
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+
+    const LexSpec& getSpec() const;
+    // 转移表是否来自缓存
+    bool fromCache() const;
+    // 最小化DFA的扁平转移表
+    const ScanTable& getTable() const;
+    // 各阶段的耗时和计数
+    const LexStats& getStats() const;
+    // 是否已有转移表（命中缓存或已构建完成）
+    bool isBuilt() const;
+    // NFA -> DFA -> MDFA -> 转移表，并写入缓存；已有转移表时直接返回
+    // progress 要求取消时抛出 LexCancelled，已完成的阶段保留，再次调用时从未完成的阶段继续
+    void build(LexBuildProgress progress = nullptr);
+    // 命中缓存时以下自动机在首次访问时才构建，progress 同 build
+    Nfa& getNfa(LexBuildProgress progress = nullptr);
+    Dfa& getDfa(LexBuildProgress progress = nullptr);
+    MDfa& getMDfa(LexBuildProgress progress = nullptr);
+
+    // 生成分词程序代码并流式写入os，返回写入字节数
+    size_t generate(std::ostream& os, CodeGenProgress progress = nullptr);
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 22:03:45
+ * @LastEditTime: 2026-10-19 22:03:45
+ * @FilePath: /XLEX/include/lexprogress.h
+ * @Description: 自动机构建的进度回调和取消
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _LEXPROGRESS_H
+#define _LEXPROGRESS_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+// 构建阶段
+enum LexBuildStage {
+    LEX_BUILD_NFA, // Thompson 构造
+    LEX_BUILD_DFA, // 子集构造
+    LEX_BUILD_MDFA, // 最小化
+    LEX_BUILD_TABLE, // 扁平转移表和缓存
+};
+
+/**
+ * 构建进度回调：(阶段, 已完成数, 当前总数)
+ * 阶段结束时由 Lexer 汇报 done == total，此时该阶段的结果已经可以通过 Lexer 读取
+ * 子集构造的总数是已发现的DFA状态数，最小化的已完成数是当前划分数，总数是DFA状态数，都会随构建变化
+ * 回调在构建所在的线程上调用，返回 false 时取消构建
+ */
+typedef std::function<bool(LexBuildStage, size_t, size_t)> LexBuildProgress;
+
+// 构建被进度回调取消，已完成的阶段保留，之后可以继续构建
+struct LexCancelled : std::exception {
+    const char* what() const noexcept override {
+        return "automaton build cancelled";
+    }
+};
+
+// 汇报进度，回调要求取消时抛出 LexCancelled
+inline void lexReportProgress(const LexBuildProgress& progress, LexBuildStage stage, size_t done, size_t total) {
+    if (progress && !progress(stage, done, total)) throw LexCancelled();
+}
+
+#endif
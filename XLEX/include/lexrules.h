@@ -0,0 +1,83 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 22:48:36
+ * @LastEditTime: 2026-10-19 23:59:53
+ * @FilePath: /XLEX/include/lexrules.h
+ * @Description: 逐条规则的增量检查：按正则缓存各规则的自动机，只重建改动过的规则，并找出能匹配同一个串的规则
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _LEXRULES_H
+#define _LEXRULES_H
+
+#include "lexspec.h"
+#include "lexprogress.h"
+#include "scantable.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 单条规则的检查结果
+struct LexRuleInfo {
+    std::string name; // OP 的 Label 或 IDENTIFIER、NUMBER、COMMENT
+    std::string regex;
+    size_t nfaNodes = 0;
+    size_t dfaStates = 0;
+    size_t mdfaStates = 0;
+    bool reused = false; // 自动机是否来自上一次检查
+    std::string error; // 正则语法有误时的说明，此时不构建自动机，也不参与冲突检查
+};
+
+// 两条规则能匹配同一个串
+struct LexConflict {
+    std::string first; // 规则名称，按规则在总正则中的顺序
+    std::string second;
+    std::string example; // 最短的冲突串之一，为空表示两条规则都能匹配空串
+};
+
+// 一次检查的结果
+struct LexCheckReport {
+    std::vector<LexRuleInfo> rules; // 与 LexSpec::rules 一一对应
+    std::vector<LexConflict> conflicts;
+    size_t rebuilt = 0; // 本次重新构建的规则数
+    double ms = 0; // 检查耗时
+};
+
+/**
+ * 规则检查缓存：每条规则先检查正则语法，再单独构建 NFA -> DFA -> MDFA -> 转移表，按正则文本缓存，
+ * 两条规则的冲突在两张转移表的乘积上广度优先搜索，结果按正则对缓存
+ * 编辑规则时只有改动过的规则及其所在的规则对需要重新计算，不再使用的缓存项在每次检查后丢弃
+ * 不是线程安全的，同一时间只能在一个线程上检查
+ */
+class LexRuleCache {
+public:
+    // progress 转发各规则子集构造、最小化的进度，每完成一条规则或一对规则时以 LEX_BUILD_TABLE 汇报 (已完成, 总数)
+    // 要求取消时抛出 LexCancelled，已构建完成的规则保留在缓存中
+    LexCheckReport check(const LexSpec& spec, LexBuildProgress progress = nullptr);
+    // 丢弃所有缓存
+    void clear();
+
+private:
+    // 一条规则编译后的结果
+    struct CompiledRule {
+        size_t nfaNodes;
+        size_t dfaStates;
+        size_t mdfaStates;
+        ScanTable table;
+    };
+    // 两条规则的冲突检查结果
+    struct Overlap {
+        bool conflict;
+        std::string example;
+    };
+
+    std::map<std::string, std::shared_ptr<const CompiledRule> > compiled; // 正则 -> 自动机
+    std::map<std::pair<std::string, std::string>, Overlap> overlaps; // (正则, 正则) -> 冲突
+
+    static std::shared_ptr<const CompiledRule> compile(const std::string& regex, const LexBuildProgress& progress);
+    // 两张转移表是否都能接受同一个串，能接受时写入最短的一个
+    static Overlap overlap(const ScanTable& first, const ScanTable& second);
+};
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 11:02:17
+ * @LastEditTime: 2026-10-19 22:48:36
+ * @FilePath: /XLEX/include/lexspec.h
+ * @Description: YAML 分词规则读取、校验和正则拼接（不依赖 Qt）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _LEXSPEC_H
+#define _LEXSPEC_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+#include "lexstats.h"
+
+// 分词规则
+struct LexSpec {
+    std::map<std::string, std::string> reserved; // 关键字 -> Label
+    std::map<std::string, std::string> op; // 运算符（已去除转译字符） -> Label
+    std::string identifier; // 替换 LETTER、DIGIT 后的标识符正则
+    std::string number; // 替换 DIGIT 后的数字正则
+    std::string letter;
+    std::string digit;
+    std::string comment;
+    std::string regex; // 拼接后的总正则表达式
+    std::vector<std::pair<std::string, std::string> > rules; // 拼成总正则的各条规则：(名称, 正则)，名称为 OP 的 Label 或 IDENTIFIER、NUMBER、COMMENT
+};
+
+/**
+ * YAML 文件的定义如下：
+ * 需要包含大写的 identifier、number、reserved、letter、digit、comment、op
+ * reserved、op 块需要为 key-value 对，其中 reserved 是 key-array 对，op 是 key-string 对
+ * letter、digit 为 string 数组
+ * 其他块都为 string 的 value
+*/
+// 检查YAML文件合法性，不合法时返回false并写入error
+bool checkLexSpec(YAML::Node& doc, std::string& error);
+
+// 根据已校验的YAML生成分词规则
+void buildLexSpec(YAML::Node& doc, LexSpec& spec);
+
+// 读取YAML文本 -> 校验 -> 生成分词规则，失败时返回false并写入error
+// stats 非空时记录 YAML 解析（load）和正则拼接（preprocess）的耗时
+bool loadLexSpec(std::string text, LexSpec& spec, std::string& error, LexStats* stats = nullptr);
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 20:05:12
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /XLEX/include/lexstats.h
+ * @Description: 分词器构建各阶段的耗时、计数和内存分配（不依赖 Qt）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _LEXSTATS_H
+#define _LEXSTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// 单个阶段的统计，阶段可能执行多次（如命中缓存后再手动构建DFA），数据累加
+// 内存数据只在程序链接了计数分配器（common/memhook.cpp，命令行工具和基准测试）时记录，计数为全进程范围
+struct LexStage {
+    double ms = 0; // 累计耗时（毫秒）
+    size_t runs = 0; // 执行次数
+    size_t allocated = 0; // 阶段内分配的字节数
+    size_t allocations = 0; // 阶段内分配次数
+    long long retained = 0; // 阶段结束时仍存活的新增字节数，阶段释放了之前的内存时为负
+    size_t peak = 0; // 阶段内存活字节数相对阶段开始时的最大增量
+};
+
+// YAML -> 正则 -> NFA -> DFA -> MDFA -> 转移表 -> 代码 各阶段的统计
+struct LexStats {
+    LexStage load; // 解析、校验 YAML
+    LexStage preprocess; // 拼接总正则、插入连接符
+    LexStage nfa; // Thompson 构造
+    LexStage dfa; // 子集构造
+    LexStage mdfa; // 最小化
+    LexStage table; // 生成扁平转移表
+    LexStage cache; // 读写缓存文件
+    LexStage codegen; // 代码生成
+
+    size_t nfaNodes = 0; // NFA 节点数
+    size_t closures = 0; // EPSILON 闭包计算次数
+    size_t dfaStates = 0; // DFA 状态数
+    size_t subsetComparisons = 0; // 子集构造时新状态和已有状态的比较次数
+    size_t partitionSplits = 0; // 最小化时拆分出的划分数
+    size_t mdfaStates = 0; // 最小化DFA 状态数
+    bool cached = false; // 转移表是否来自缓存
+
+    // 以 JSON 对象输出：{"stages":{...},"counters":{...},"cached":...}，记录了内存时阶段带有内存字段
+    std::string toJson() const;
+};
+
+// 是否链接了计数分配器，计数见 common/memcount.h
+bool lexMemoryCounted();
+
+// 阶段计时器：析构时把经过的时间和内存分配累加到阶段上，stage 为空时不计时
+// 阶段之间不能嵌套，否则外层阶段的峰值会被内层重置
+class LexStageTimer {
+private:
+    LexStage* stage;
+    std::chrono::steady_clock::time_point begin;
+    size_t allocated = 0; // 开始时的计数
+    size_t allocations = 0;
+    size_t live = 0;
+
+public:
+    explicit LexStageTimer(LexStage* stage);
+    ~LexStageTimer();
+    LexStageTimer(const LexStageTimer&) = delete;
+    LexStageTimer& operator=(const LexStageTimer&) = delete;
+};
+
+#endif
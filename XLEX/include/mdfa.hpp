@@ -1,7 +1,7 @@
 /*
  * @Author: 翁行
  * @Date: 2023-12-31 23:00:20
- * @LastEditTime: 2024-05-31 00:45:54
+ * @LastEditTime: 2026-10-19 22:03:45
  * @FilePath: /XLEX/include/mdfa.hpp
  * @Description: DFA最小化
  * Copyright 2024 (c) 翁行, All Rights Reserved.
@@ -56,13 +56,22 @@ class MDfa {
 private:
     Dfa& dfa;
     vector<MDfaNode*> nodes;
+    LexStats* stats; // 构建统计，可为空
+    LexBuildProgress progress; // 构建进度，可为空
+
+    void release() {
+        for (MDfaNode* node : nodes) delete node;
+        nodes.clear();
+    }
 
     void minimize() { // 最小化
+        LexStageTimer timer(stats ? &stats->mdfa : nullptr);
         set<char> symbols = dfa.getNfa().getSymbols(); // 转移符号
         set<DfaNode*> left, right; // 两个拆分
         vector<set<DfaNode*>> completed; // 已完成拆分
         vector<set<DfaNode*>> prepared; // 待拆分
         map<int, set<DfaNode*>> destination; // 转移目的地，做暂存使用
+        size_t dfaStates = dfa.getNodes().size();
         // 根据是否终结节点初始化
         for (DfaNode* node : dfa.getNodes()) {
             if (node->isEnd) right.insert(node);
@@ -70,60 +79,68 @@ private:
         }
         completed.push_back(left);
         completed.push_back(right);
-        for (const char symbol : symbols) {
-            prepared = completed;
-            completed.clear();
-            while (prepared.size()) {
-                if (prepared.empty()) break;
-                destination.clear();
-                set<DfaNode*> cur = prepared.front();
-                if (cur.empty()) {
-                    prepared.erase(prepared.begin(), prepared.begin() + 1); // 把cur出队
-                    continue; // 空集合
-                }
-                if (cur.size() == 1) {
-                    completed.push_back(cur); // 长度为1，无需拆分
-                    prepared.erase(prepared.begin(), prepared.begin() + 1);
-                    continue;
-                }
-                for (DfaNode* node : cur) {
-                    if (!node->transfers.count(symbol)) { // 不存在该转移
-                        destination[-1].insert(node);
+        // 按某个字符拆分后，之前按其他字符稳定的划分可能不再稳定，需要重复直到一轮内没有拆分
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const char symbol : symbols) {
+                prepared = completed;
+                completed.clear();
+                while (prepared.size()) {
+                    if (prepared.empty()) break;
+                    lexReportProgress(progress, LEX_BUILD_MDFA, completed.size() + prepared.size(), dfaStates);
+                    destination.clear();
+                    set<DfaNode*> cur = prepared.front();
+                    if (cur.empty()) {
+                        prepared.erase(prepared.begin(), prepared.begin() + 1); // 把cur出队
+                        continue; // 空集合
+                    }
+                    if (cur.size() == 1) {
+                        completed.push_back(cur); // 长度为1，无需拆分
+                        prepared.erase(prepared.begin(), prepared.begin() + 1);
                         continue;
                     }
-                    int target = node->transfers[symbol]; // 下一个DFA状态
-                    for (int i = 0; i < prepared.size(); ++i) {
-                        bool matched = false;
-                        for (DfaNode* state : prepared[i]) {
-                            if (state->state == target) { // 移进的目标是这个集合
-                                matched = true;
-                                destination[i].insert(node);
-                                break;
+                    for (DfaNode* node : cur) {
+                        if (!node->transfers.count(symbol)) { // 不存在该转移
+                            destination[-1].insert(node);
+                            continue;
+                        }
+                        int target = node->transfers[symbol]; // 下一个DFA状态
+                        for (int i = 0; i < prepared.size(); ++i) {
+                            bool matched = false;
+                            for (DfaNode* state : prepared[i]) {
+                                if (state->state == target) { // 移进的目标是这个集合
+                                    matched = true;
+                                    destination[i].insert(node);
+                                    break;
+                                }
                             }
+                            if (matched) break;
                         }
-                        if (matched) break;
-                    }
-                    for (int i = 0; i < completed.size(); ++i) {
-                        bool matched = false;
-                        for (DfaNode* state : completed[i]) {
-                            if (state->state == target) { // 移进的目标是这个集合
-                                matched = true;
-                                destination[prepared.size() + i].insert(node);
-                                break;
+                        for (int i = 0; i < completed.size(); ++i) {
+                            bool matched = false;
+                            for (DfaNode* state : completed[i]) {
+                                if (state->state == target) { // 移进的目标是这个集合
+                                    matched = true;
+                                    destination[prepared.size() + i].insert(node);
+                                    break;
+                                }
                             }
+                            if (matched) break;
                         }
-                        if (matched) break;
                     }
+                    prepared.erase(prepared.begin(), prepared.begin() + 1); // 把cur出队
+                    // 找内奸
+                    if (destination.size() > 1) { // 有内奸
+                        if (stats) stats->partitionSplits += destination.size() - 1;
+                        changed = true;
+                        for (auto& p : destination)
+                            prepared.push_back(p.second);
+                        continue;
+                    }
+                    // 没有内奸
+                    completed.push_back(cur);
                 }
-                prepared.erase(prepared.begin(), prepared.begin() + 1); // 把cur出队
-                // 找内奸
-                if (destination.size() > 1) { // 有内奸
-                    for (auto& p : destination)
-                        prepared.push_back(p.second);
-                    continue;
-                }
-                // 没有内奸
-                completed.push_back(cur);
             }
         }
         // 根据划分结果生成MDFA结点
@@ -158,6 +175,7 @@ private:
                     instance->bindDfaNodes(divide);
                     for (MDfaNode* exist : nodes) { // 寻找是否已经存在该结点
                         if (*exist == *instance) {
+                            delete instance;
                             instance = exist;
                             break;
                         }
@@ -169,6 +187,7 @@ private:
                 }
             }
         }
+        if (stats) stats->mdfaStates = nodes.size();
     }
 
     // 以symbol步进的结果集合
@@ -182,9 +201,22 @@ private:
     }
 
 public:
-    MDfa(Dfa& dfa) : dfa(dfa) {
-        minimize();
+    // progress 要求取消时释放已生成的节点并抛出 LexCancelled
+    MDfa(Dfa& dfa, LexStats* stats = nullptr, LexBuildProgress progress = nullptr) : dfa(dfa), stats(stats), progress(progress) {
+        try {
+            minimize();
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+        this->progress = nullptr;
     };
+    ~MDfa() {
+        release();
+    }
+    MDfa(const MDfa&) = delete;
+    MDfa& operator=(const MDfa&) = delete;
 
     // 获取MDFA节点列表
     vector<MDfaNode*> getNodes() {
@@ -1,7 +1,7 @@
 /*
  * @Author: 翁行
  * @Date: 2023-12-31 15:06:30
- * @LastEditTime: 2024-05-23 22:58:56
+ * @LastEditTime: 2026-10-19 23:59:53
  * @FilePath: /XLEX/include/nfa.hpp
  * @Description: 输入解析和NFA图生成
  * Copyright 2024 (c) 翁行, All Rights Reserved.
@@ -11,12 +11,14 @@
 
 #include <iostream>
 #include "globals.h"
+#include "lexstats.h"
 #include <cstring>
 #include <string>
 #include <vector>
 #include <map>
 #include <set>
 #include <stack>
+#include <stdexcept>
 
 using namespace std;
 
@@ -122,6 +124,7 @@ private:
     // 问号闭包
     NfaGraph setClosureStar(NfaGraph& target) {
         NfaGraph graph(new NfaNode, new NfaNode);
+        graph.end->isEnd = true;
         target.updateState(1);
         graph.end->state = target.end->state + 1;
         target.end->isEnd = false;
@@ -134,6 +137,7 @@ private:
     // 正闭包
     NfaGraph setClosurePlus(NfaGraph& target) {
         NfaGraph graph(new NfaNode, new NfaNode);
+        graph.end->isEnd = true;
         target.updateState(1);
         graph.end->state = target.end->state + 1;
         target.end->isEnd = false;
@@ -175,14 +179,12 @@ private:
         subgraphs.push(result);
     }
 
-    // 生成顶层NFA图
-    void generate(string input) {
+    // 预处理输入字符串：中括号换成括号，并在需要的位置加入CONCAT（中括号内为UNION）
+    static string preprocess(const string& input) {
         bool translate = false; // 转译字符作用
         string prepared = ""; // 预处理后的输入字符串
-        stack<char> ops; // 符号栈
-        stack<NfaGraph> subgraphs; // 子图栈
         bool inBracket = false; // 在中括号中
-        for (int i = 0; i < input.size(); ++i) { // 预处理输入字符串（加入CONCAT字符）
+        for (int i = 0; i < input.size(); ++i) { // 加入CONCAT字符
             char id = input[i];
             if (id == '\\' && !translate) {
                 translate = true; // 开启转译
@@ -220,8 +222,98 @@ private:
                 )) prepared.push_back(inBracket ? UNION : CONCAT); // 不是这些情况就手动加入联结符号
             translate = false;
         }
-        cout << "Prepared RegExp: " << prepared << '\n';
-        translate = false;
+        return prepared;
+    }
+
+    // 运算符在错误信息里的名称
+    static string opName(char op) {
+        if (op == CONCAT) return "连接";
+        return string("运算符 ") + op;
+    }
+
+    // 按 generate 的顺序执行运算，只数各层括号内的操作数，不生成子图
+    static bool checkPrepared(const string& prepared, string& error) {
+        bool translate = false;
+        stack<char> ops;
+        stack<size_t> bases; // 各层左括号处的操作数个数，括号内的运算不能用到括号外的操作数
+        size_t operands = 0;
+        bases.push(0);
+        auto apply = [&](char op) {
+            size_t need = (op == CLOSURE || op == CLOSURE_PLUS || op == CLOSURE_STAR) ? 1 : 2;
+            if (operands < bases.top() + need) {
+                error = opName(op) + " 缺少操作数";
+                return false;
+            }
+            operands -= need - 1;
+            return true;
+        };
+        for (int i = 0; i < prepared.size(); ++i) {
+            char id = prepared[i];
+            if (id == '\\' && !translate) {
+                translate = true;
+                continue;
+            }
+            if (id == LBRACKET && !translate) {
+                ops.push(id);
+                bases.push(operands);
+                continue;
+            }
+            if (id == RBRACKET && !translate) {
+                while (ops.size() && ops.top() != LBRACKET) {
+                    if (!apply(ops.top())) return false;
+                    ops.pop();
+                }
+                if (ops.empty()) {
+                    error = "缺少左括号";
+                    return false;
+                }
+                ops.pop();
+                if (operands != bases.top() + 1) {
+                    error = "括号内为空";
+                    return false;
+                }
+                bases.pop();
+                continue;
+            }
+            if (_reservedSymbol(id) && !translate) {
+                while (ops.size() && _privilege(id) <= _privilege(ops.top())) {
+                    if (!apply(ops.top())) return false;
+                    ops.pop();
+                }
+                ops.push(id);
+                continue;
+            }
+            operands++;
+            translate = false;
+        }
+        while (ops.size()) {
+            if (ops.top() == LBRACKET) {
+                error = "缺少右括号";
+                return false;
+            }
+            if (!apply(ops.top())) return false;
+            ops.pop();
+        }
+        if (operands != 1) {
+            error = "正则表达式为空";
+            return false;
+        }
+        return true;
+    }
+
+    // 生成顶层NFA图，正则有误时抛出 invalid_argument
+    void generate(string input) {
+        string prepared; // 预处理后的输入字符串
+        {
+            LexStageTimer timer(stats ? &stats->preprocess : nullptr);
+            prepared = preprocess(input);
+        }
+        string error;
+        if (!checkPrepared(prepared, error)) throw invalid_argument(error);
+        LexStageTimer timer(stats ? &stats->nfa : nullptr);
+        bool translate = false; // 转译字符作用
+        stack<char> ops; // 符号栈
+        stack<NfaGraph> subgraphs; // 子图栈
         for (int i = 0; i < prepared.size(); ++i) {
             char id = prepared[i]; // 当前Identifier
             if (id == '\\' && !translate) {
@@ -264,15 +356,24 @@ private:
             setAction(op, subgraphs);
         }
         this->graph = subgraphs.top(); // 栈顶就是顶层NFA图
+        // 子图编号连续，终结节点编号最大
+        if (stats) stats->nfaNodes = graph.end->state + 1;
     }
 
     NfaGraph graph; // 顶层NFA图
     set<char> symbols; // 转移字符
+    LexStats* stats; // 构建统计，可为空
 public:
-    Nfa(string input) {
+    // 正则有误时抛出 invalid_argument，可先用 check 检查
+    Nfa(string input, LexStats* stats = nullptr) : stats(stats) {
         generate(input);
     }
 
+    // 检查正则语法（括号匹配、运算符都有操作数、不为空），有误时返回false并写入error
+    static bool check(const string& input, string& error) {
+        return checkPrepared(preprocess(input), error);
+    }
+
     // 获取转移字符集
     set<char> getSymbols() {
         return symbols;
@@ -0,0 +1,122 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 21:40:26
+ * @LastEditTime: 2026-10-19 22:03:45
+ * @FilePath: /XLEX/include/nfasim.hpp
+ * @Description: 直接在NFA图上模拟的参考匹配器，作为DFA、MDFA和各分词后端的对照
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _NFASIM_HPP
+#define _NFASIM_HPP
+
+#include "nfa.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// NFA模拟器：状态集合按NFA节点编号升序保存，不做任何缓存，只求简单可靠
+// 转移语义与子集构造、转移表一致：集合中有节点存在字符c的显式转移时只走显式转移，
+// 否则走任意字符转移（换行符除外）；输入字符 ANY 本身只能走任意字符转移
+class NfaSimulator {
+private:
+    vector<NfaNode*> nodes; // 编号 -> 节点
+    NfaNode* begin; // 顶层NFA图的起始节点
+    int end; // 顶层NFA图的终结节点编号
+
+    // 把节点及其EPSILON闭包加入集合
+    void addClosure(NfaNode* source, vector<char>& marked, vector<int>& states) const {
+        vector<NfaNode*> prepared(1, source);
+        while (prepared.size()) {
+            NfaNode* cur = prepared.back();
+            prepared.pop_back();
+            if (marked[cur->state]) continue;
+            marked[cur->state] = 1;
+            states.push_back(cur->state);
+            auto it = cur->transfers.find(EPSILON);
+            if (it == cur->transfers.end()) continue;
+            for (NfaNode* next : it->second) prepared.push_back(next);
+        }
+    }
+
+    // 集合中所有节点在symbol上的转移目标（含闭包）
+    vector<int> move(const vector<int>& states, char symbol) const {
+        vector<char> marked(nodes.size());
+        vector<int> result;
+        for (int state : states) {
+            auto it = nodes[state]->transfers.find(symbol);
+            if (it == nodes[state]->transfers.end()) continue;
+            for (NfaNode* next : it->second) addClosure(next, marked, result);
+        }
+        sort(result.begin(), result.end());
+        return result;
+    }
+
+    // 集合中是否有节点存在symbol上的转移
+    // 节点上可能有空的转移列表，不能只看键是否存在
+    bool hasTransfer(const vector<int>& states, char symbol) const {
+        for (int state : states) {
+            auto it = nodes[state]->transfers.find(symbol);
+            if (it != nodes[state]->transfers.end() && it->second.size()) return true;
+        }
+        return false;
+    }
+
+public:
+    NfaSimulator(Nfa& nfa) {
+        NfaGraph graph = nfa.getGraph();
+        begin = graph.start;
+        end = graph.end->state;
+        nodes.resize(end + 1);
+        // 子图编号连续，按编号收集所有节点
+        vector<NfaNode*> prepared(1, graph.start);
+        while (prepared.size()) {
+            NfaNode* cur = prepared.back();
+            prepared.pop_back();
+            if (nodes[cur->state]) continue;
+            nodes[cur->state] = cur;
+            for (auto& p : cur->transfers)
+                for (NfaNode* next : p.second)
+                    prepared.push_back(next);
+        }
+    }
+
+    // 初始状态集合：起始节点的EPSILON闭包
+    vector<int> start() const {
+        vector<char> marked(nodes.size());
+        vector<int> states;
+        addClosure(begin, marked, states);
+        sort(states.begin(), states.end());
+        return states;
+    }
+
+    // 读入字符c后的状态集合，为空时表示无转移
+    vector<int> step(const vector<int>& states, char c) const {
+        if (c != ANY && hasTransfer(states, c)) return move(states, c);
+        if (c == '\n') return vector<int>();
+        return move(states, ANY);
+    }
+
+    // 集合是否包含顶层NFA图的终结节点
+    bool isEnd(const vector<int>& states) const {
+        return binary_search(states.begin(), states.end(), end);
+    }
+
+    // 集合中是否有节点存在任意字符转移
+    bool hasAny(const vector<int>& states) const {
+        return hasTransfer(states, ANY);
+    }
+
+    // 整个输入是否被接受
+    bool accepts(const string& input) const {
+        vector<int> states = start();
+        for (char c : input) {
+            states = step(states, c);
+            if (states.empty()) return false;
+        }
+        return isEnd(states);
+    }
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 16:42:18
+ * @LastEditTime: 2026-10-19 23:59:59
+ * @FilePath: /XLEX/include/scancache.h
+ * @Description: 编译后自动机的持久化缓存：按规则哈希存取扁平转移表，读取时直接映射文件
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _SCANCACHE_H
+#define _SCANCACHE_H
+
+#include "lexspec.h"
+#include "scantable.h"
+#include <cstdint>
+#include <string>
+
+// 缓存文件格式版本，格式或自动机构建语义变化时需递增
+#define SCAN_CACHE_VERSION 3 // 2：修正最小化和 ?、+ 闭包的终结状态；3：meta 段保存总正则，用于核对规则
+
+/**
+ * 缓存文件布局（小端、8字节对齐，可直接映射使用）：
+ * 文件头 magic "XLEXSCAN"、版本、字节序标记、规则哈希、字符类数、状态数、各段偏移和长度
+ * classOf 段：256 个 int32，字符 -> 字符类
+ * transfers 段：stateCount * classCount 个 int32，-1 为无转移
+ * flags 段：stateCount 个 uint8，SCAN_ACCEPT | SCAN_ANY
+ * meta 段：转移字符、总正则，以及 reserved、op 的 lexeme -> Label 对（长度前缀字符串）
+ */
+
+// 分词规则的哈希（FNV-1a 64），作为缓存的键
+uint64_t hashLexSpec(const LexSpec& spec);
+
+// 分词规则在缓存目录下对应的缓存文件路径
+std::string scanCachePath(const std::string& dir, const LexSpec& spec);
+
+// 写入缓存文件（先写临时文件再改名），失败时返回false并写入error
+bool saveScanCache(const std::string& path, const LexSpec& spec, const ScanTable& table, std::string& error);
+
+// 映射并校验缓存文件，哈希、版本或数据不符时返回false并写入error
+// 成功时 table 引用映射的文件数据，spec 的 regex、reserved、op 由缓存填充
+bool loadScanCache(const std::string& path, uint64_t hash, LexSpec& spec, ScanTable& table, std::string& error);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 14:10:26
+ * @LastEditTime: 2026-10-19 14:10:26
+ * @FilePath: /XLEX/include/scanner.h
+ * @Description: 基于扁平转移表的进程内分词器，行为与生成的分词程序一致
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _SCANNER_H
+#define _SCANNER_H
+
+#include "lexer.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 分词结果：Label 编号（Scanner::getLabels 的下标）和源文本区间 [begin, end)
+struct LexToken {
+    int label = -1;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// 分词器
+class Scanner {
+private:
+    ScanTable table;
+    LexSpec spec;
+    std::vector<std::string> labels; // 所有 Label
+    std::unordered_map<std::string_view, int> lexemes; // 关键字、运算符 -> Label 编号
+    int numberLabel;
+    int commentLabel;
+    int identifierLabel;
+
+    int labelOf(const std::string& label);
+    int classify(std::string_view token) const;
+
+public:
+    explicit Scanner(Lexer& lexer);
+    Scanner(const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
+
+    // 分词游标，source 需在游标使用期间有效
+    class Cursor {
+    private:
+        const Scanner& scanner;
+        const char* data;
+        size_t size;
+        size_t pos = 0;
+        std::string error;
+
+    public:
+        Cursor(const Scanner& scanner, const std::string& source);
+        // 读取下一个分词，结束或出错时返回false
+        bool next(LexToken& token);
+        // 出错信息，空则无出错
+        const std::string& getError() const;
+    };
+
+    Cursor scan(const std::string& source) const;
+    const ScanTable& getTable() const;
+    const std::vector<std::string>& getLabels() const;
+    int getCommentLabel() const;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 16:05:51
+ * @LastEditTime: 2026-10-19 16:05:51
+ * @FilePath: /XLEX/include/scantable.h
+ * @Description: 最小化DFA的扁平转移表，可由MDFA生成或从缓存文件映射
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef _SCANTABLE_H
+#define _SCANTABLE_H
+
+#include "mdfa.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 状态标记
+#define SCAN_ACCEPT 1 // 终结状态
+#define SCAN_ANY 2 // 含有任意字符转移
+
+// 最小化DFA的扁平转移表，数据由 storage 持有（内存中的数组或映射的缓存文件）
+struct ScanTable {
+    int classCount = 0; // 字符类数量
+    int stateCount = 0; // 状态数量
+    const int32_t* classOf = nullptr; // 字符（按 unsigned char）-> 字符类，共256项
+    const int32_t* transfers = nullptr; // [state * classCount + class] -> 目标状态，-1 为无转移
+    const uint8_t* flags = nullptr; // 每个状态的 SCAN_ACCEPT | SCAN_ANY 标记
+    std::string symbols; // 转移字符（含 ANY），有序
+    std::shared_ptr<const void> storage;
+
+    // 由MDFA生成转移表，任意字符转移（换行符除外）已合并进表中
+    static ScanTable build(MDfa& mdfa, const std::set<char>& symbols);
+
+    // 状态state在字符c上的转移，-1 为无转移
+    int32_t next(int state, char c) const {
+        return transfers[(size_t)state * classCount + classOf[(unsigned char)c]];
+    }
+
+    // 状态state的任意字符转移目标，没有时为-1
+    int32_t anyTarget(int state) const {
+        // ANY 本身不会作为显式转移，所以它总是落在任意字符转移上
+        return (flags[state] & SCAN_ANY) ? next(state, ANY) : -1;
+    }
+};
+
+#endif
@@ -1,445 +1,300 @@
 /*
  * @Author: 翁行
  * @Date: 2024-05-07 13:14:38
- * @LastEditTime: 2024-05-28 01:58:40
+ * @LastEditTime: 2026-10-19 23:59:47
  * @FilePath: /XLEX/lexitemdialog.cpp
  * @Description: 生成NFA、DFA、MDFA表的UI
  * Copyright 2024 (c) 翁行, All Rights Reserved.
  */
 
 #include "lexitemdialog.h"
+#include "automatonmodel.h"
 #include "codepreviewer.h"
 #include "./ui_lexitemdialog.h"
+#include <QApplication>
+#include <QDir>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QThread>
+#include <chrono>
+#include <climits>
 #include <sstream>
 #include <fstream>
 
-LexItemDialog::LexItemDialog(YAML::Node& doc, QWidget* parent) :
+LexItemDialog::LexItemDialog(const LexSpec& spec, const LexStats& stats, QWidget* parent) :
     QDialog(parent),
-    ui(new Ui::LexItemDialog) {
+    ui(new Ui::LexItemDialog),
+    lexer(nullptr) {
     ui->setupUi(this);
     this->setWindowTitle("状态转换图");
-    init(doc);
+    init(spec, stats);
 }
 
 LexItemDialog::~LexItemDialog() {
+    // 先停止后台构建，再释放它正在使用的分词器
+    if (worker) {
+        cancelRequested = true;
+        worker->wait();
+        delete worker;
+    }
     delete ui;
-    if (nfa) delete nfa;
-    if (dfa) delete dfa;
-    if (mdfa) delete mdfa;
+    if (lexer) delete lexer;
 }
 
-// 读取YAML输入->YAML解析->NFA->DFA->MDFA
-void LexItemDialog::init(YAML::Node& doc) {
-    // 所有保留字
-    for (auto it = doc["RESERVED"].begin(); it != doc["RESERVED"].end(); ++it) {
-        for (auto item : it->second) {
-            reserved[item.as<std::string>()] = it->first.as<std::string>();
-        }
-    }
-    // 所有OP
-    for (auto it = doc["OP"].begin(); it != doc["OP"].end(); ++it) {
-        op[it->second.as<std::string>()] = it->first.as<std::string>();
-    }
-    digit = "";
-    for (int i = 0; i < doc["DIGIT"].size(); ++i) {
-        digit += doc["DIGIT"][i].as<std::string>();
-        if (i != doc["DIGIT"].size() - 1) digit += "|";
-    }
-    letter = "";
-    for (int i = 0; i < doc["LETTER"].size(); ++i) {
-        letter += doc["LETTER"][i].as<std::string>();
-        if (i != doc["LETTER"].size() - 1) letter += "|";
-    }
-
-    qDebug("[LETTER] %s", letter.c_str());
-    qDebug("[DIGIT] %s", digit.c_str());
-
-    identifier = doc["IDENTIFIER"].as<std::string>();
-    number = doc["NUMBER"].as<std::string>();
-    comment = doc["COMMENT"].as<std::string>();
-
-
-    // 替换 identifier 里的 digit、number 和 letter
-    _replaceAll(number, "DIGIT", "(" + digit + ")");
-    _replaceAll(identifier, "NUMBER", number);
-    _replaceAll(identifier, "LETTER", "(" + letter + ")");
-    _replaceAll(identifier, "DIGIT", "(" + digit + ")");
-
-    qDebug("[IDENTIFIER] %s", identifier.c_str());
-    qDebug("[NUMBER] %s", number.c_str());
-    qDebug("[COMMENT] %s", comment.c_str());
-
-    // 拼接总的正则表达式
-    std::vector<std::string> tokens;
-    for (auto it = op.begin(); it != op.end(); ++it) {
-        tokens.push_back(it->first);
-    }
-    if (identifier.size() > 0) {
-        tokens.push_back(identifier);
-    }
-    if (number.size() > 0) {
-        tokens.push_back(number);
-    }
-    if (comment.size() > 0) {
-        tokens.push_back(comment);
-    }
-    regex = "";
-    for (int it = 0; it < tokens.size(); ++it) {
-        regex += tokens[it];
-        if (it != tokens.size() - 1) regex += "|";
+// 分词规则->NFA->DFA->MDFA
+void LexItemDialog::init(const LexSpec& spec, const LexStats& stats) {
+    qDebug("[LETTER] %s", spec.letter.c_str());
+    qDebug("[DIGIT] %s", spec.digit.c_str());
+    qDebug("[IDENTIFIER] %s", spec.identifier.c_str());
+    qDebug("[NUMBER] %s", spec.number.c_str());
+    qDebug("[COMMENT] %s", spec.comment.c_str());
+    qDebug("[REGEX] %s", spec.regex.c_str());
+
+    // 编译好的自动机按规则哈希缓存在用户缓存目录下，未命中时在后台构建
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/automata";
+    QDir().mkpath(cacheDir);
+    lexer = new Lexer(spec, cacheDir.toUtf8().toStdString(), stats, true);
+
+    // 命中缓存时不构建DFA，需要查看时再手动构建
+    ui->buildDfa->setVisible(lexer->fromCache());
+    if (lexer->isBuilt()) {
+        ui->buildPanel->setVisible(false);
+        this->generateNfaTable();
+        this->generateMDfaTable();
+        this->renderStats(lexer->getStats());
+        return;
     }
+    // NFA -> DFA -> MDFA，各阶段完成后依次显示
+    startBuild([this](LexBuildProgress progress) {
+        lexer->build(progress);
+    });
+}
 
-    qDebug("[REGEX] %s", regex.c_str());
-
-    nfa = new Nfa(regex);
-    dfa = new Dfa(*nfa);
-    mdfa = new MDfa(*dfa);
-
-    // NFA -> DFA -> MDFA
-    this->generateNfaTable();
-    this->generateDfaTable();
-    this->generateMDfaTable();
+// 手动构建并渲染DFA表
+void LexItemDialog::on_buildDfa_clicked() {
+    ui->buildDfa->setEnabled(false);
+    startBuild([this](LexBuildProgress progress) {
+        lexer->getDfa(progress);
+    });
+}
 
-    // map里的key要把转译字符删掉
-    std::map<std::string, std::string> reserved;
-    std::map<std::string, std::string> op;
-    for (auto& it : this->reserved) {
-        reserved[_removeEscape(it.first)] = it.second;
+// 构建中取消；已取消时从未完成的阶段继续构建
+void LexItemDialog::on_cancelBuild_clicked() {
+    if (worker) {
+        cancelRequested = true;
+        ui->cancelBuild->setEnabled(false);
+        ui->buildStatus->setText("正在取消...");
+        return;
     }
-    for (auto& it : this->op) {
-        op[_removeEscape(it.first)] = it.second;
-    }
-    this->reserved = reserved;
-    this->op = op;
+    startBuild(lastJob);
 }
 
-// 渲染NFA表
-void LexItemDialog::generateNfaTable() {
-    NfaGraph nfaGraph = nfa->getGraph();
-
-    std::set<char> symbols = nfa->getSymbols();
-    symbols.insert(EPSILON);
-    std::vector<std::map<char, std::string>> transfers(nfaGraph.end->state + 1);
-    std::vector<int> visited(nfaGraph.end->state + 1);
-    std::queue<NfaNode*> queue;
-
-    // BFS生成一张二维表
-    queue.push(nfaGraph.start);
-    while (queue.size()) {
-        NfaNode* cur = queue.front();
-        queue.pop();
-        if (visited[cur->state]) {
-            continue;
+void LexItemDialog::startBuild(BuildJob job) {
+    lastJob = job;
+    cancelRequested = false;
+    ui->buildPanel->setVisible(true);
+    ui->buildStatus->setText("正在构建...");
+    ui->buildProgress->setRange(0, 0);
+    ui->cancelBuild->setText("取消");
+    ui->cancelBuild->setEnabled(true);
+    // 代码生成会读写统计，后台线程构建期间也在写，构建结束前不能生成
+    ui->codeGenerate->setEnabled(false);
+
+    // 回调在后台线程上执行：进度按时间节流后投递到界面线程，阶段完成时带上统计快照
+    std::chrono::steady_clock::time_point lastPost;
+    LexBuildProgress progress = [this, lastPost](LexBuildStage stage, size_t done, size_t total) mutable {
+        // 最小化的划分数可能中途等于DFA状态数，只以转移表完成为准
+        // 阶段结果此时已保存在 lexer 中，继续构建时不会再汇报，所以先投递显示再响应取消
+        if (done == total && stage != LEX_BUILD_MDFA) {
+            LexStats snapshot = lexer->getStats();
+            QMetaObject::invokeMethod(this, [this, stage, snapshot]() {
+                onBuildStageFinished(stage, snapshot);
+            }, Qt::QueuedConnection);
+            return !cancelRequested;
         }
-        visited[cur->state] = 1;
-        for (auto& p : cur->transfers) {
-            std::string target = "";
-            for (NfaNode* next : p.second) {
-                if (!visited[next->state]) {
-                    queue.push(next);
-                    target += to_string(next->state) + ", ";
-                }
-            }
-            target = target.substr(0, target.size() - 2);
-            transfers[cur->state][p.first] = target;
+        if (cancelRequested) return false;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPost < std::chrono::milliseconds(100)) return true;
+        lastPost = now;
+        QMetaObject::invokeMethod(this, [this, stage, done, total]() {
+            onBuildProgress(stage, done, total);
+        }, Qt::QueuedConnection);
+        return true;
+    };
+    worker = QThread::create([this, job, progress]() {
+        bool cancelled = false;
+        QString error;
+        try {
+            job(progress);
         }
-    }
-
-    QTableWidget* nfaTable = ui->nfaTable;
-    nfaTable->setColumnCount(symbols.size() + 1);
-    nfaTable->setRowCount(transfers.size());
-    // 设置nfaTable Header
-    QStringList header;
-    header << "状态";
-    for (char symbol : symbols) {
-        if (symbol == EPSILON) {
-            header << "EPSILON";
-            continue;
+        catch (const LexCancelled&) {
+            cancelled = true;
         }
-        header << QString(1, symbol);
-    }
-    nfaTable->setHorizontalHeaderLabels(header);
-    nfaTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-
-
-    // 设置nfaTable Content
-    for (int i = 0; i < transfers.size(); ++i) {
-        nfaTable->setItem(i, 0, new QTableWidgetItem(QString::number(i)));
-        int col = 1;
-        for (char symbol : symbols) {
-            if (transfers[i].count(symbol)) {
-                nfaTable->setItem(i, col, new QTableWidgetItem(QString(transfers[i][symbol].c_str())));
-            }
-            col += 1;
+        catch (const std::exception& e) {
+            error = e.what();
         }
-    }
+        LexStats snapshot = lexer->getStats();
+        QMetaObject::invokeMethod(this, [this, cancelled, error, snapshot]() {
+            onBuildFinished(cancelled, error, snapshot);
+        }, Qt::QueuedConnection);
+    });
+    worker->start();
 }
 
-// 生成DFA表
-void LexItemDialog::generateDfaTable() {
-    std::vector<DfaNode*> nodes = dfa->getNodes();
-    std::set<char> symbols = nfa->getSymbols();
-    QTableWidget* dfaTable = ui->dfaTable;
-    dfaTable->setColumnCount(symbols.size() + 1);
-    dfaTable->setRowCount(nodes.size());
-
-    QStringList header;
-    header << "状态";
-    for (char symbol : symbols) {
-        header << QString(1, symbol);
-    }
-    dfaTable->setHorizontalHeaderLabels(header);
-    dfaTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-
-    for (int i = 0; i < nodes.size(); ++i) {
-        DfaNode* cur = nodes[i];
-        // 状态编号
-        dfaTable->setItem(i, 0, new QTableWidgetItem(QString::number(i)));
-        int col = 1;
-        for (char symbol : symbols) {
-            if (cur->transfers.count(symbol)) {
-                dfaTable->setItem(i, col, new QTableWidgetItem(QString::number(cur->transfers[symbol])));
-            }
-            col++;
-        }
+// 显示当前阶段的进度
+void LexItemDialog::onBuildProgress(LexBuildStage stage, size_t done, size_t total) {
+    switch (stage) {
+    case LEX_BUILD_NFA:
+        ui->buildStatus->setText("NFA 构造...");
+        ui->buildProgress->setRange(0, 0);
+        return;
+    case LEX_BUILD_DFA:
+        ui->buildStatus->setText(QString("子集构造：%1 / %2 个状态").arg(done).arg(total));
+        break;
+    case LEX_BUILD_MDFA:
+        ui->buildStatus->setText(QString("DFA 最小化：%1 个划分 / %2 个状态").arg(done).arg(total));
+        break;
+    case LEX_BUILD_TABLE:
+        ui->buildStatus->setText("生成转移表...");
+        ui->buildProgress->setRange(0, 0);
+        return;
     }
+    // 进度条只支持 int
+    int scale = total > (size_t)INT_MAX ? (int)(total / INT_MAX + 1) : 1;
+    ui->buildProgress->setRange(0, (int)(total / scale));
+    ui->buildProgress->setValue((int)(done / scale));
 }
 
-// 生成最小化DFA表
-void LexItemDialog::generateMDfaTable() {
-    std::set<char> symbols = nfa->getSymbols();
-    std::vector<MDfaNode*> nodes = mdfa->getNodes();
-
-    QTableWidget* mdfaTable = ui->mdfaTable;
-    mdfaTable->setColumnCount(symbols.size() + 1);
-    mdfaTable->setRowCount(nodes.size());
-
-    QStringList header;
-    header << "状态";
-    for (char symbol : symbols) {
-        header << QString(1, symbol);
+// 阶段完成后立即显示它的结果
+void LexItemDialog::onBuildStageFinished(LexBuildStage stage, const LexStats& stats) {
+    switch (stage) {
+    case LEX_BUILD_NFA:
+        this->generateNfaTable();
+        break;
+    case LEX_BUILD_DFA:
+        this->generateDfaTable();
+        break;
+    case LEX_BUILD_TABLE:
+        this->generateMDfaTable();
+        break;
+    default:
+        break;
     }
-    mdfaTable->setHorizontalHeaderLabels(header);
-    mdfaTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    this->renderStats(stats);
+}
 
-    for (int i = 0; i < nodes.size(); ++i) {
-        MDfaNode* cur = nodes[i];
-        // 状态编号
-        mdfaTable->setItem(i, 0, new QTableWidgetItem(QString::number(i)));
-        int col = 1;
-        for (char symbol : symbols) {
-            if (cur->transfer.count(symbol)) {
-                mdfaTable->setItem(i, col, new QTableWidgetItem(QString::number(cur->transfer[symbol])));
-            }
-            col++;
-        }
+void LexItemDialog::onBuildFinished(bool cancelled, const QString& error, const LexStats& stats) {
+    worker->wait();
+    delete worker;
+    worker = nullptr;
+    this->renderStats(stats);
+    ui->codeGenerate->setEnabled(lexer->isBuilt());
+    if (cancelled || error.size()) {
+        // 已完成的阶段保留，可以继续构建
+        ui->buildStatus->setText(cancelled ? QString("构建已取消") : "构建失败：" + error);
+        ui->buildProgress->setRange(0, 1);
+        ui->buildProgress->setValue(0);
+        ui->cancelBuild->setText("继续构建");
+        ui->cancelBuild->setEnabled(true);
+        return;
     }
+    ui->buildPanel->setVisible(false);
+    if (lexer->fromCache()) ui->buildDfa->setVisible(false);
 }
 
-// 代码生成
-QString LexItemDialog::codeGenerate() {
-    std::vector<MDfaNode*> nodes = mdfa->getNodes();
-    QString code;
-    // 库文件
-    code +=
-        "#include <iostream>\n"
-        "#include <string>\n"
-        "#include <cstring>\n"
-        "#include <vector>\n"
-        "#include <map>\n"
-        "#include <sstream>\n"
-        "#include <fstream>\n\n";
-    // namespace
-    code += "using namespace std;\n\n";
-
-    // RESERVED 关键字
-    code += "map<string, string> reserved = {\n";
-    for (auto& it : reserved) {
-        code += "\t{\"" + it.first + "\", \"" + it.second + "\"},\n";
+// 渲染各阶段耗时和计数，未执行的阶段不显示
+void LexItemDialog::renderStats(const LexStats& stats) {
+    const std::pair<QString, const LexStage*> stages[] = {
+        { "YAML 读取", &stats.load },
+        { "正则预处理", &stats.preprocess },
+        { "NFA 构造", &stats.nfa },
+        { "子集构造", &stats.dfa },
+        { "DFA 最小化", &stats.mdfa },
+        { "转移表", &stats.table },
+        { "缓存读写", &stats.cache },
+        { "代码生成", &stats.codegen },
+    };
+    bool memory = lexMemoryCounted();
+    QString text;
+    for (auto& it : stages) {
+        if (!it.second->runs) continue;
+        text += QString("%1: %2 ms").arg(it.first).arg(it.second->ms, 0, 'f', 3);
+        if (memory) {
+            const LexStage& stage = *it.second;
+            text += QString("，分配 %1 KB / %2 次，留存 %3 KB，峰值 %4 KB")
+                .arg(stage.allocated / 1024.0, 0, 'f', 1)
+                .arg(stage.allocations)
+                .arg(stage.retained / 1024.0, 0, 'f', 1)
+                .arg(stage.peak / 1024.0, 0, 'f', 1);
+        }
+        text += '\n';
     }
-    code += "};\n";
-
-    // OP 运算符
-    code += "map<string, string> op = {\n";
-    for (auto& it : op) {
-        code += "\t{\"" + it.first + "\", \"" + it.second + "\"},\n";
+    if (stats.cached) text += "转移表来自缓存\n";
+    if (stats.nfaNodes) text += QString("NFA 节点数: %1\n").arg(stats.nfaNodes);
+    if (stats.closures) text += QString("EPSILON 闭包计算次数: %1\n").arg(stats.closures);
+    if (stats.dfaStates) {
+        text += QString("DFA 状态数: %1\n").arg(stats.dfaStates);
+        text += QString("子集比较次数: %1\n").arg(stats.subsetComparisons);
     }
-    code += "};\n";
-
-    // 工具方法：是否数字Token
-    code +=
-        "bool isNumber(string token) {\n"
-        "\tif (token.size() < 1) return false;\n"
-        "\tif (token[0] >= '0' && token[0] <= '9') return true;\n"
-        "\treturn false;\n"
-        "}\n";
-
-    // 工具方法：是否注释Token
-    code +=
-        "bool isComment(string token) {\n"
-        "\tif (token.size() < 2) return false;\n"
-        "\tif (token[0] >= 'a' && token[0] <= 'z' || token[0] >= 'A' && token[0] <= 'Z') return false;\n"
-        "\treturn true;\n"
-        "}\n";
+    if (stats.partitionSplits) text += QString("划分拆分次数: %1\n").arg(stats.partitionSplits);
+    text += QString("MDFA 状态数: %1\n").arg(stats.mdfaStates);
+    ui->statsView->setPlainText(text);
+}
 
-    // 工具方法：string转小写
-    code +=
-        "string toLowerCase(string token) {\n"
-        "\tstring ret = \"\";\n"
-        "\tfor (auto c : token) ret += tolower(c);\n"
-        "\treturn ret;\n"
-        "}\n";
+// 渲染NFA表：模型只在单元格可见时读取节点
+void LexItemDialog::generateNfaTable() {
+    setupAutomatonView(ui->nfaTable, new NfaTableModel(lexer->getNfa(), this));
+}
 
-    // 处理Token的方法
-    code +=
-        "void handleToken(string token, ofstream& os) {\n"
-        "\tif (token.size() == 0) return;\n"
-        "\tstring label;\n"
-        "\tif (reserved.count(token)) label = reserved[token];\n"
-        "\telse if (op.count(token)) label = op[token];\n"
-        "\telse if (isNumber(token)) label = \"NUMBER\";\n"
-        "\telse if (isComment(token)) label = \"COMMENT\";\n"
-        "\telse label = \"IDENTIFIER\";\n"
-        "\tcout << label << \" : \" << token << '\\n';\n"
-        "\tos << label << \" : \" << token << '\\n';\n"
-        "}\n";
+// 生成DFA表
+void LexItemDialog::generateDfaTable() {
+    setupAutomatonView(ui->dfaTable, new DfaTableModel(lexer->getDfa(), lexer->getNfa().getSymbols(), this));
+}
 
-    // 主函数头
-    code += "int main(int argc, char* argv[]) {\n";
-    // 入参校验
-    code +=
-        "\tif (argc != 3) {\n"
-        "\t\t cout << \"Error: Invalid input. Require input file path on agrv[1] and output file path on agrv[2]. \" << '\\n';\n"
-        "\t\t return 1;\n"
-        "\t}\n";
-    // 源代码文件path
-    code += "\tstring path = argv[1];\n";
-    // 输出文件path
-    code += "\tstring outputPath = argv[2];\n";
-    // 打开文件
-    code +=
-        "\tifstream ifs(path);\n"
-        "\tofstream os(outputPath);\n"
-        "\tif (!ifs || !ifs.is_open()) {\n"
-        "\t\tcout << \"Error: Cannot open input file. \" << '\\n';\n"
-        "\t\treturn 1;\n"
-        "\t}\n"
-        "\tif (!os || !os.is_open()) {\n"
-        "\t\tcout << \"Error: Cannot open output file. \" << '\\n';\n"
-        "\t\treturn 1;\n"
-        "\t}\n";
-    // 读取源代码
-    code +=
-        "\tstringstream ss;\n"
-        "\tss << ifs.rdbuf();\n"
-        "\tstring code = ss.str();\n"
-        "\tstring token = \"\";\n"
-        "\tss.clear();\n"
-        "\tss.str(\"\");\n";
-    // 初始状态
-    code += "\tint currentState = 0;\n";
-    // 循环遍历
-    code +=
-        "\tfor (int i = 0; i < code.size(); ++i) {\n"
-        "\t\tchar id = code[i];\n"
-        "\t\tswitch(currentState) {\n";
-    for (MDfaNode* node : nodes) {
-        code +=
-            "\t\t\tcase " + QString::number(node->state) + ":\n"
-            "\t\t\t\tswitch (id) {\n";
-        for (auto& p : node->transfer) {
-            if (p.first == ANY) continue;
-            code +=
-                "\t\t\t\t\tcase '" + QString(p.first) + "':\n"
-                "\t\t\t\t\t\tcurrentState = " + QString::number(p.second) + ";\n"
-                "\t\t\t\t\t\ttoken += id;\n"
-                "\t\t\t\t\t\tbreak;\n";
-        }
-        if (node->transfer.count(ANY)) {
-            code +=
-                "\t\t\t\t\tdefault:\n"
-                "\t\t\t\t\tif (id == '\\n') {\n"
-                "\t\t\t\t\t\tif (token.size() > 0) {\n"
-                "\t\t\t\t\t\t\thandleToken(token, os);\n"
-                "\t\t\t\t\t\t\ttoken = \"\";\n"
-                "\t\t\t\t\t\t}\n"
-                "\t\t\t\t\t\tcurrentState = 0;\n"
-                "\t\t\t\t\t}\n"
-                "\t\t\t\t\telse {\n"
-                "\t\t\t\t\tcurrentState = " + QString::number(node->transfer[ANY]) + ";\n"
-                "\t\t\t\t\ttoken += id;\n"
-                "\t\t\t\t\t}\n"
-                "\t\t\t\t\tbreak;\n";
-        }
-        else {
-            if (node->isEnd) {
-                // 拿到一个分词，重新开始
-                code +=
-                    "\t\t\t\t\tdefault:\n"
-                    "\t\t\t\t\t\tif (token.size() > 0) {\n"
-                    "\t\t\t\t\t\t\thandleToken(token, os);\n"
-                    "\t\t\t\t\t\t\ttoken = \"\";\n"
-                    "\t\t\t\t\t\t\tif (id != '\\n' && id != ' ' && id != '\\t') {\n"
-                    "\t\t\t\t\t\t\t\ti--;\n"
-                    "\t\t\t\t\t\t\t}\n"
-                    "\t\t\t\t\t\t}\n"
-                    "\t\t\t\t\t\tcurrentState = 0;\n";
-            }
-            else {
-                // 其他情况为错误情形
-                code +=
-                    "\t\t\t\t\tdefault:\n"
-                    "\t\t\t\t\tif (id == '\\n' || id == ' ' || id == '\\t') {\n"
-                    "\t\t\t\t\t\tif (token.size() == 0) {\n"
-                    "\t\t\t\t\t\t\tbreak;\n"
-                    "\t\t\t\t\t\t}\n"
-                    "\t\t\t\t\t}\n"
-                    "\t\t\t\t\t\tos << \"Error: Invalid input character. \" << '\\n';\n"
-                    "\t\t\t\t\t\tcout << \"Error: Invalid input character. \" << '\\n';\n"
-                    "\t\t\t\t\t\treturn 1;\n";
-            }
-        }
-        code +=
-            "\t\t\t\t}\n"
-            "\t\t\tbreak;\n";
-    }
-    code +=
-        "\t\t}\n"
-        "\t}\n";
+// 生成最小化DFA表，直接读取转移表，命中缓存时无需构建自动机
+void LexItemDialog::generateMDfaTable() {
+    setupAutomatonView(ui->mdfaTable, new ScanTableModel(lexer->getTable(), this));
+}
 
-    // 读取完毕，根据最终状态取到最后的分词
-    code += "\tswitch(currentState) {\n";
-    for (auto node : nodes) {
-        if (node->isEnd) {
-            code +=
-                "\t\tcase " + QString::number(node->state) + ":\n";
-        }
+// 代码生成：流式写入path指向的文件，并显示进度
+bool LexItemDialog::codeGenerate(const QString& path) {
+    std::ofstream os(QFile::encodeName(path).constData(), std::ios::out | std::ios::binary);
+    if (!os.is_open()) {
+        return false;
     }
-    code +=
-        "\t\t\tif (token.size() > 0) {\n"
-        "\t\t\t\thandleToken(token, os);\n"
-        "\t\t\t}\n"
-        "\t\t\tbreak;\n";
-    // 其他情况为错误情形
-    code +=
-        "\t\tdefault:\n"
-        "\t\t\tcout << \"Error: Invalid input. \" << '\\n';\n"
-        "\t\t\treturn 1;"
-        "\t}\n";
-    // 主函数尾
-    code +=
-        "\tcout << \"Success.\" << '\\n';\n"
-        "\treturn 0;\n"
-        "}\n";
-    return code;
+    QProgressDialog progress("正在生成代码...", QString(), 0, lexer->getTable().stateCount, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    lexer->generate(os, [&](size_t done, size_t total) {
+        progress.setMaximum((int)total);
+        progress.setValue((int)done);
+        QCoreApplication::processEvents();
+    });
+    os.close();
+    this->renderStats(lexer->getStats());
+    return !os.fail();
 }
 
 // 触发生成代码
 void LexItemDialog::on_codeGenerate_clicked() {
-    QString code = codeGenerate();
-    CodePreviewer* codePreviewer = new CodePreviewer(code, this);
+    // 生成的代码先写入临时文件，预览窗口只加载开头部分，保存时直接复制该文件
+    QTemporaryFile temp(QDir::temp().filePath("xlex-XXXXXX.cpp"));
+    temp.setAutoRemove(false);
+    if (!temp.open()) {
+        QMessageBox::warning(this, "警告", "无法创建临时文件");
+        return;
+    }
+    QString path = temp.fileName();
+    temp.close();
+    if (!codeGenerate(path)) {
+        QFile::remove(path);
+        QMessageBox::warning(this, "警告", "代码生成失败");
+        return;
+    }
+    CodePreviewer* codePreviewer = new CodePreviewer(path, this);
     codePreviewer->show();
 }
-
@@ -7,10 +7,11 @@
 #define LEXITEMDIALOG_H
 
 #include <QDialog>
-#include "nfa.hpp"
-#include "dfa.hpp"
-#include "mdfa.hpp"
-#include <yaml-cpp/yaml.h>
+#include "lexer.h"
+#include <atomic>
+#include <functional>
+
+class QThread;
 
 namespace Ui {
     class LexItemDialog;
@@ -20,38 +21,43 @@ class LexItemDialog : public QDialog {
     Q_OBJECT
 
 public:
-    explicit LexItemDialog(YAML::Node& doc, QWidget* parent = nullptr);
+    // stats 为读取规则时的统计，构建自动机的统计在其基础上继续记录
+    explicit LexItemDialog(const LexSpec& spec, const LexStats& stats = LexStats(), QWidget* parent = nullptr);
     ~LexItemDialog();
 
 private slots:
     void on_codeGenerate_clicked();
+    void on_buildDfa_clicked();
+    void on_cancelBuild_clicked();
 
 private:
-    Ui::LexItemDialog* ui;
+    typedef std::function<void(LexBuildProgress)> BuildJob;
 
-    std::string regex;
-    std::map<std::string, std::string> reserved;
-    std::map<std::string, std::string> op;
-    std::string identifier;
-    std::string number;
-    std::string letter;
-    std::string digit;
-    std::string comment;
-
-    Nfa* nfa;
-    Dfa* dfa;
-    MDfa* mdfa;
+    Ui::LexItemDialog* ui;
 
-    void init(YAML::Node&);
+    Lexer* lexer;
+    QThread* worker = nullptr; // 后台构建线程，空闲时为空
+    std::atomic<bool> cancelRequested{ false };
+    BuildJob lastJob; // 最近一次的构建任务，取消后可以继续
+
+    void init(const LexSpec&, const LexStats&);
+    // 在后台线程上运行构建任务，构建期间只在界面线程上读取已完成阶段的结果
+    void startBuild(BuildJob job);
+    // 以下在界面线程上调用
+    void onBuildProgress(LexBuildStage stage, size_t done, size_t total);
+    void onBuildStageFinished(LexBuildStage stage, const LexStats& stats);
+    void onBuildFinished(bool cancelled, const QString& error, const LexStats& stats);
     // 生成NFA图
     void generateNfaTable();
     // 生成DFA图
     void generateDfaTable();
     // 生成MDFA图
     void generateMDfaTable();
+    // 渲染各阶段耗时和计数，构建期间使用后台线程提供的快照
+    void renderStats(const LexStats& stats);
 
-    // 代码生成
-    QString codeGenerate();
+    // 代码生成，流式写入文件
+    bool codeGenerate(const QString& path);
 };
 
 #endif // LEXITEMDIALOG_H
@@ -1,7 +1,7 @@
 /*
  * @Author: 翁行
  * @Date: 2024-05-07 13:07:19
- * @LastEditTime: 2024-05-26 15:43:33
+ * @LastEditTime: 2026-10-19 23:59:53
  * @FilePath: /XLEX/mainwindow.cpp
  * @Description: 主窗口
  * Copyright 2024 (c) 翁行, All Rights Reserved.
@@ -11,8 +11,13 @@
 #include "QFileDialog"
 #include "QMessageBox"
 #include "lexitemdialog.h"
+#include "lexspec.h"
+#include <QThread>
+#include <QTimer>
 #include <sstream>
-#include <yaml-cpp/yaml.h>
+
+// 停止编辑多久后开始检查
+static const int CHECK_DELAY_MS = 400;
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -22,11 +27,116 @@ MainWindow::MainWindow(QWidget* parent)
 }
 
 MainWindow::~MainWindow() {
+    // 先停止后台检查，再释放界面
+    if (checkWorker) {
+        checkCancelled = true;
+        checkWorker->wait();
+        delete checkWorker;
+    }
     delete ui;
 }
 
 void MainWindow::init() {
+    // 每次编辑都重新计时，停顿后才检查
+    checkTimer = new QTimer(this);
+    checkTimer->setSingleShot(true);
+    checkTimer->setInterval(CHECK_DELAY_MS);
+    connect(checkTimer, &QTimer::timeout, this, &MainWindow::startCheck);
+    connect(ui->lexEditor, &QTextEdit::textChanged, this, [this]() {
+        checkTimer->start();
+    });
+}
+
+void MainWindow::startCheck() {
+    // 上一次检查还没结束：取消它，结束后再用最新的文本检查
+    if (checkWorker) {
+        checkCancelled = true;
+        checkPending = true;
+        return;
+    }
+    checkPending = false;
+    checkCancelled = false;
+    ui->checkLabel->setText("规则检查：正在检查...");
+
+    std::string text = ui->lexEditor->toPlainText().toStdString();
+    checkWorker = QThread::create([this, text]() {
+        LexSpec spec;
+        LexCheckReport report;
+        std::string error;
+        bool cancelled = false;
+        if (loadLexSpec(text, spec, error)) {
+            try {
+                report = ruleCache.check(spec, [this](LexBuildStage, size_t, size_t) {
+                    return !checkCancelled;
+                });
+            }
+            catch (const LexCancelled&) {
+                cancelled = true;
+            }
+            catch (const std::exception& e) {
+                error = e.what();
+            }
+        }
+        QString message = QString::fromStdString(error);
+        QMetaObject::invokeMethod(this, [this, cancelled, message, report]() {
+            onCheckFinished(cancelled, message, report);
+        }, Qt::QueuedConnection);
+    });
+    checkWorker->start();
+}
 
+void MainWindow::onCheckFinished(bool cancelled, const QString& error, const LexCheckReport& report) {
+    checkWorker->wait();
+    delete checkWorker;
+    checkWorker = nullptr;
+    if (checkPending) {
+        startCheck();
+        return;
+    }
+    ui->checkLabel->setText("规则检查");
+    if (!cancelled) renderCheck(error, report);
+}
+
+// 显示检查结果：错误，或冲突和各规则的状态数
+void MainWindow::renderCheck(const QString& error, const LexCheckReport& report) {
+    if (error.size()) {
+        ui->checkView->setHtml("<p style=\"color:#c00\">" + error.toHtmlEscaped() + "</p>");
+        return;
+    }
+    QString html = QString("<p>%1 条规则，重新构建 %2 条，用时 %3 ms</p>")
+        .arg(report.rules.size()).arg(report.rebuilt).arg(report.ms, 0, 'f', 1);
+    // 语法有误的规则没有构建，也没有参与冲突检查
+    bool invalid = false;
+    for (const LexRuleInfo& rule : report.rules) {
+        if (rule.error.empty()) continue;
+        invalid = true;
+        html += QString("<p style=\"color:#c00\">%1 的正则有误：%2</p>")
+            .arg(QString::fromStdString(rule.name).toHtmlEscaped())
+            .arg(QString::fromStdString(rule.error).toHtmlEscaped());
+    }
+    if (report.conflicts.empty() && !invalid) {
+        html += "<p style=\"color:#080\">没有规则能匹配同一个串</p>";
+    }
+    for (const LexConflict& conflict : report.conflicts) {
+        QString example = conflict.example.empty()
+            ? QString("空串")
+            : "\"" + QString::fromStdString(conflict.example).toHtmlEscaped() + "\"";
+        html += QString("<p style=\"color:#c60\">%1 与 %2 都能匹配 %3</p>")
+            .arg(QString::fromStdString(conflict.first).toHtmlEscaped())
+            .arg(QString::fromStdString(conflict.second).toHtmlEscaped())
+            .arg(example);
+    }
+    html += "<table cellspacing=\"0\" cellpadding=\"2\">"
+        "<tr><th align=\"left\">规则</th><th>NFA</th><th>DFA</th><th>MDFA</th><th></th></tr>";
+    for (const LexRuleInfo& rule : report.rules) {
+        html += QString("<tr><td title=\"%1\">%2</td><td align=\"right\">%3</td><td align=\"right\">%4</td>"
+            "<td align=\"right\">%5</td><td>%6</td></tr>")
+            .arg(QString::fromStdString(rule.regex).toHtmlEscaped())
+            .arg(QString::fromStdString(rule.name).toHtmlEscaped())
+            .arg(rule.nfaNodes).arg(rule.dfaStates).arg(rule.mdfaStates)
+            .arg(rule.error.size() ? "有误" : rule.reused ? "" : "已重建");
+    }
+    ui->checkView->setHtml(html + "</table>");
 }
 
 // 导入文件
@@ -52,77 +162,18 @@ void MainWindow::on_importFileAction_clicked() {
         QMessageBox::information(this, "提示", "读取失败");
 }
 
-/**
- * YAML 文件的定义如下：
- * 需要包含大写的 identifier、number、reserved、letter、digit、comment、op
- * reserved、op 块需要为 key-value 对，其中 reserved 是 key-array 对，op 是 key-string 对
- * letter、digit 为 string 数组
- * 其他块都为 string 的 value
-*/
+// 解析YAML规则（定义见 lexspec.h），校验通过后打开状态转换图窗口
 void MainWindow::on_parseFileAction_clicked() {
     std::string str = ui->lexEditor->toPlainText().toStdString();
-    // 替换空格
-    std::string preload = _replaceAll(str, " | ", "|");
-    YAML::Node doc;
-    // YAML 文件可能在解析时抛出错误
-    try {
-        doc = YAML::Load(preload);
-    }
-    catch (const std::exception& e) {
-        qDebug("YAML::Exception: %s", e.what());
-        QMessageBox::warning(this, "警告", "YAML 文件解析错误");
+    LexSpec spec;
+    LexStats stats;
+    std::string error;
+    if (!loadLexSpec(str, spec, error, &stats)) {
+        qDebug("LexSpec: %s", error.c_str());
+        QMessageBox::warning(this, "警告", QString::fromStdString(error));
         return;
     }
-    if (!doc.IsMap()) {
-        QMessageBox::warning(this, "警告", "YAML 文件不是Key-Value对");
-        return;
-    }
-    QVector<QString> requiredKey = {
-        "RESERVED",
-        "OP",
-        "LETTER",
-        "DIGIT",
-        "NUMBER",
-        "IDENTIFIER",
-        "COMMENT"
-    };
-
-    // YAML 文件合法性检查
-    for (QString key : requiredKey) {
-        YAML::Node value = doc[key.toStdString()];
-        if (!value) {
-            QMessageBox::warning(this, "警告", "缺少 " + key + " 标识");
-            return;
-        }
-        if (key == "RESERVED" || key == "OP") {
-            if (!value.IsMap()) {
-                QMessageBox::warning(this, "警告", key + " 标识不是Key-Value对");
-                return;
-            }
-            if (key == "RESERVED") {
-                for (auto it = value.begin(); it != value.end(); ++it) {
-                    if (!it->second.IsSequence()) {
-                        QMessageBox::warning(this, "警告", key + " 标识不是string数组");
-                        return;
-                    }
-                }
-            }
-        }
-        else if (key == "LETTER" || key == "DIGIT") {
-            if (!value.IsSequence()) {
-                QMessageBox::warning(this, "警告", key + " 标识不是string数组");
-                return;
-            }
-        }
-        else {
-            if (!value.IsScalar()) {
-                QMessageBox::warning(this, "警告", key + " 标识不是string");
-                return;
-            }
-        }
-    }
 
-    LexItemDialog* dialog = new LexItemDialog(doc, this);
+    LexItemDialog* dialog = new LexItemDialog(spec, stats, this);
     dialog->show();
 }
-
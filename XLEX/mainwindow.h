@@ -7,6 +7,11 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include "lexrules.h"
+#include <atomic>
+
+class QThread;
+class QTimer;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -38,7 +43,19 @@ private:
     std::string digit;
     std::string comment;
 
+    // 编辑规则时的自动检查：停顿一段时间后在后台线程上逐条规则检查，只重建改动过的规则
+    QTimer* checkTimer = nullptr;
+    QThread* checkWorker = nullptr; // 后台检查线程，空闲时为空
+    std::atomic<bool> checkCancelled{ false };
+    bool checkPending = false; // 检查期间又有编辑，结束后重新检查
+    LexRuleCache ruleCache; // 只在后台检查线程上访问，同一时间只有一个检查
+
     // 初始化UI
     void init();
+    // 以下在界面线程上调用
+    // 在后台线程上检查编辑器中的规则，上一次检查未结束时先取消它
+    void startCheck();
+    void onCheckFinished(bool cancelled, const QString& error, const LexCheckReport& report);
+    void renderCheck(const QString& error, const LexCheckReport& report);
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,110 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 11:20:43
+ * @LastEditTime: 2026-10-19 23:59:59
+ * @FilePath: /XLEX/src/lexer.cpp
+ * @Description: 分词器构建 LexSpec -> NFA -> DFA -> MDFA -> 代码（不依赖 Qt）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexer.h"
+#include "scancache.h"
+
+// 缓存 -> 转移表，或 NFA -> DFA -> MDFA -> 转移表
+Lexer::Lexer(const LexSpec& spec, const std::string& cacheDir, const LexStats& stats, bool deferred) : spec(spec), stats(stats) {
+    if (cacheDir.size()) {
+        LexStageTimer timer(&this->stats.cache);
+        std::string error;
+        cachePath = scanCachePath(cacheDir, this->spec);
+        LexSpec meta;
+        // 哈希相同时再核对一遍总正则（决定自动机）和 reserved、op，防止碰撞
+        if (loadScanCache(cachePath, hashLexSpec(this->spec), meta, table, error) && meta.regex == this->spec.regex
+            && meta.reserved == this->spec.reserved && meta.op == this->spec.op) {
+            cached = true;
+            this->stats.cached = true;
+            this->stats.mdfaStates = table.stateCount;
+            return;
+        }
+        table = ScanTable();
+    }
+    if (!deferred) build();
+}
+
+bool Lexer::isBuilt() const {
+    return table.stateCount > 0;
+}
+
+void Lexer::build(LexBuildProgress progress) {
+    if (isBuilt()) return;
+    MDfa& mdfa = getMDfa(progress);
+    lexReportProgress(progress, LEX_BUILD_TABLE, 0, 1);
+    {
+        LexStageTimer timer(&this->stats.table);
+        table = ScanTable::build(mdfa, getNfa().getSymbols());
+    }
+    // 缓存写入失败不影响使用
+    if (cachePath.size()) {
+        LexStageTimer timer(&this->stats.cache);
+        std::string error;
+        saveScanCache(cachePath, this->spec, table, error);
+    }
+    // 转移表已生成，之后不再取消
+    if (progress) progress(LEX_BUILD_TABLE, 1, 1);
+}
+
+Lexer::~Lexer() {
+    if (mdfa) delete mdfa;
+    if (dfa) delete dfa;
+    if (nfa) delete nfa;
+}
+
+const LexSpec& Lexer::getSpec() const {
+    return spec;
+}
+
+bool Lexer::fromCache() const {
+    return cached;
+}
+
+const ScanTable& Lexer::getTable() const {
+    return table;
+}
+
+const LexStats& Lexer::getStats() const {
+    return stats;
+}
+
+Nfa& Lexer::getNfa(LexBuildProgress progress) {
+    if (!nfa) {
+        lexReportProgress(progress, LEX_BUILD_NFA, 0, 1);
+        nfa = new Nfa(spec.regex, &stats);
+        lexReportProgress(progress, LEX_BUILD_NFA, 1, 1);
+    }
+    return *nfa;
+}
+
+Dfa& Lexer::getDfa(LexBuildProgress progress) {
+    if (!dfa) {
+        Nfa& source = getNfa(progress);
+        dfa = new Dfa(source, &stats, progress);
+        size_t states = dfa->getNodes().size();
+        lexReportProgress(progress, LEX_BUILD_DFA, states, states);
+    }
+    return *dfa;
+}
+
+MDfa& Lexer::getMDfa(LexBuildProgress progress) {
+    if (!mdfa) {
+        Dfa& source = getDfa(progress);
+        mdfa = new MDfa(source, &stats, progress);
+        size_t states = dfa->getNodes().size();
+        lexReportProgress(progress, LEX_BUILD_MDFA, states, states);
+    }
+    return *mdfa;
+}
+
+// 代码生成
+size_t Lexer::generate(std::ostream& os, CodeGenProgress progress) {
+    LexStageTimer timer(&stats.codegen);
+    CodeGenerator generator(table, spec.reserved, spec.op);
+    return generator.emit(os, progress);
+}
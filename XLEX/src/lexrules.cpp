@@ -0,0 +1,146 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 22:48:36
+ * @LastEditTime: 2026-10-19 23:59:53
+ * @FilePath: /XLEX/src/lexrules.cpp
+ * @Description: 逐条规则的增量检查：按正则缓存各规则的自动机，只重建改动过的规则，并找出能匹配同一个串的规则
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexrules.h"
+#include "dfa.hpp"
+#include "mdfa.hpp"
+#include "nfa.hpp"
+#include <chrono>
+#include <set>
+
+// 单独构建一条规则的转移表
+std::shared_ptr<const LexRuleCache::CompiledRule> LexRuleCache::compile(const std::string& regex, const LexBuildProgress& progress) {
+    LexStats stats;
+    Nfa nfa(regex, &stats);
+    Dfa dfa(nfa, &stats, progress);
+    MDfa mdfa(dfa, &stats, progress);
+    std::shared_ptr<CompiledRule> rule = std::make_shared<CompiledRule>();
+    rule->nfaNodes = stats.nfaNodes;
+    rule->dfaStates = stats.dfaStates;
+    rule->mdfaStates = stats.mdfaStates;
+    rule->table = ScanTable::build(mdfa, nfa.getSymbols());
+    return rule;
+}
+
+// 在两张转移表的乘积上从 (0, 0) 广度优先搜索，第一个两边都接受的状态对给出最短的冲突串
+LexRuleCache::Overlap LexRuleCache::overlap(const ScanTable& first, const ScanTable& second) {
+    // 两边字符类都相同的字符转移也相同，每种组合只取一个代表字符，优先取可见字符
+    std::vector<char> representatives;
+    std::set<std::pair<int32_t, int32_t> > seen;
+    for (int i = 0; i < 256; ++i) {
+        int c = (i + ' ') % 256;
+        if (seen.insert({ first.classOf[c], second.classOf[c] }).second) representatives.push_back((char)c);
+    }
+
+    size_t stateCount = (size_t)first.stateCount * second.stateCount;
+    if (stateCount == 0) return Overlap{ false, "" };
+    std::vector<int64_t> parent(stateCount, -2); // 前一个状态对，-2 为未访问，-1 为起点
+    std::vector<char> via(stateCount); // 到达该状态对读入的字符
+    std::vector<size_t> prepared(1, 0);
+    parent[0] = -1;
+    for (size_t head = 0; head < prepared.size(); ++head) {
+        size_t cur = prepared[head];
+        int a = cur / second.stateCount, b = cur % second.stateCount;
+        if ((first.flags[a] & SCAN_ACCEPT) && (second.flags[b] & SCAN_ACCEPT)) {
+            Overlap result{ true, "" };
+            for (int64_t at = cur; parent[at] >= 0; at = parent[at]) result.example += via[at];
+            result.example.assign(result.example.rbegin(), result.example.rend());
+            return result;
+        }
+        for (char c : representatives) {
+            int32_t nextA = first.next(a, c), nextB = second.next(b, c);
+            if (nextA < 0 || nextB < 0) continue;
+            size_t next = (size_t)nextA * second.stateCount + nextB;
+            if (parent[next] != -2) continue;
+            parent[next] = cur;
+            via[next] = c;
+            prepared.push_back(next);
+        }
+    }
+    return Overlap{ false, "" };
+}
+
+LexCheckReport LexRuleCache::check(const LexSpec& spec, LexBuildProgress progress) {
+    auto begin = std::chrono::steady_clock::now();
+    LexCheckReport report;
+    const auto& rules = spec.rules;
+    size_t n = rules.size();
+    size_t total = n + n * (n - 1) / 2;
+    size_t done = 0;
+
+    // 逐条规则：命中缓存时直接复用，否则检查语法后单独构建；语法有误的规则记为空表
+    std::vector<std::shared_ptr<const CompiledRule> > tables;
+    std::set<std::string> used;
+    for (auto& rule : rules) {
+        LexRuleInfo info;
+        info.name = rule.first;
+        info.regex = rule.second;
+        auto it = compiled.find(rule.second);
+        info.reused = it != compiled.end();
+        if (info.reused) tables.push_back(it->second);
+        else if (!Nfa::check(rule.second, info.error)) {
+            tables.push_back(nullptr);
+            report.rules.push_back(info);
+            lexReportProgress(progress, LEX_BUILD_TABLE, ++done, total);
+            continue;
+        }
+        else {
+            tables.push_back(compile(rule.second, progress));
+            // 构建完成后才放入缓存，取消时不会留下不完整的规则
+            compiled[rule.second] = tables.back();
+            report.rebuilt++;
+        }
+        info.nfaNodes = tables.back()->nfaNodes;
+        info.dfaStates = tables.back()->dfaStates;
+        info.mdfaStates = tables.back()->mdfaStates;
+        report.rules.push_back(info);
+        used.insert(rule.second);
+        lexReportProgress(progress, LEX_BUILD_TABLE, ++done, total);
+    }
+
+    // 两两检查冲突（跳过语法有误的规则），正则对按字典序存放，交换顺序的两条规则共用一个结果
+    std::set<std::pair<std::string, std::string> > usedPairs;
+    for (size_t i = 0; i < rules.size(); ++i) {
+        for (size_t j = i + 1; j < rules.size(); ++j) {
+            if (!tables[i] || !tables[j]) {
+                lexReportProgress(progress, LEX_BUILD_TABLE, ++done, total);
+                continue;
+            }
+            bool swapped = rules[j].second < rules[i].second;
+            std::pair<std::string, std::string> key = swapped
+                ? std::make_pair(rules[j].second, rules[i].second)
+                : std::make_pair(rules[i].second, rules[j].second);
+            auto it = overlaps.find(key);
+            if (it == overlaps.end()) {
+                const ScanTable& first = tables[swapped ? j : i]->table;
+                const ScanTable& second = tables[swapped ? i : j]->table;
+                it = overlaps.emplace(key, overlap(first, second)).first;
+            }
+            usedPairs.insert(key);
+            if (it->second.conflict) report.conflicts.push_back({ rules[i].first, rules[j].first, it->second.example });
+            lexReportProgress(progress, LEX_BUILD_TABLE, ++done, total);
+        }
+    }
+
+    // 丢弃已不在规则中的缓存项
+    for (auto it = compiled.begin(); it != compiled.end();) {
+        if (used.count(it->first)) ++it;
+        else it = compiled.erase(it);
+    }
+    for (auto it = overlaps.begin(); it != overlaps.end();) {
+        if (usedPairs.count(it->first)) ++it;
+        else it = overlaps.erase(it);
+    }
+    report.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    return report;
+}
+
+void LexRuleCache::clear() {
+    compiled.clear();
+    overlaps.clear();
+}
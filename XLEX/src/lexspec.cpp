@@ -0,0 +1,165 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 11:02:17
+ * @LastEditTime: 2026-10-19 22:48:36
+ * @FilePath: /XLEX/src/lexspec.cpp
+ * @Description: YAML 分词规则读取、校验和正则拼接（不依赖 Qt）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexspec.h"
+#include "globals.h"
+#include <vector>
+
+// 检查YAML文件合法性
+bool checkLexSpec(YAML::Node& doc, std::string& error) {
+    if (!doc.IsMap()) {
+        error = "YAML 文件不是Key-Value对";
+        return false;
+    }
+    const std::vector<std::string> requiredKey = {
+        "RESERVED",
+        "OP",
+        "LETTER",
+        "DIGIT",
+        "NUMBER",
+        "IDENTIFIER",
+        "COMMENT"
+    };
+
+    for (const std::string& key : requiredKey) {
+        YAML::Node value = doc[key];
+        if (!value) {
+            error = "缺少 " + key + " 标识";
+            return false;
+        }
+        if (key == "RESERVED" || key == "OP") {
+            if (!value.IsMap()) {
+                error = key + " 标识不是Key-Value对";
+                return false;
+            }
+            if (key == "RESERVED") {
+                for (auto it = value.begin(); it != value.end(); ++it) {
+                    if (!it->second.IsSequence()) {
+                        error = key + " 标识不是string数组";
+                        return false;
+                    }
+                }
+            }
+        }
+        else if (key == "LETTER" || key == "DIGIT") {
+            if (!value.IsSequence()) {
+                error = key + " 标识不是string数组";
+                return false;
+            }
+        }
+        else {
+            if (!value.IsScalar()) {
+                error = key + " 标识不是string";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 根据YAML生成分词规则
+void buildLexSpec(YAML::Node& doc, LexSpec& spec) {
+    std::map<std::string, std::string> reserved;
+    std::map<std::string, std::string> op;
+    // 所有保留字
+    for (auto it = doc["RESERVED"].begin(); it != doc["RESERVED"].end(); ++it) {
+        for (auto item : it->second) {
+            reserved[item.as<std::string>()] = it->first.as<std::string>();
+        }
+    }
+    // 所有OP
+    for (auto it = doc["OP"].begin(); it != doc["OP"].end(); ++it) {
+        op[it->second.as<std::string>()] = it->first.as<std::string>();
+    }
+    std::string& digit = spec.digit;
+    digit = "";
+    for (int i = 0; i < doc["DIGIT"].size(); ++i) {
+        digit += doc["DIGIT"][i].as<std::string>();
+        if (i != doc["DIGIT"].size() - 1) digit += "|";
+    }
+    std::string& letter = spec.letter;
+    letter = "";
+    for (int i = 0; i < doc["LETTER"].size(); ++i) {
+        letter += doc["LETTER"][i].as<std::string>();
+        if (i != doc["LETTER"].size() - 1) letter += "|";
+    }
+
+    std::string& identifier = spec.identifier;
+    std::string& number = spec.number;
+    identifier = doc["IDENTIFIER"].as<std::string>();
+    number = doc["NUMBER"].as<std::string>();
+    spec.comment = doc["COMMENT"].as<std::string>();
+
+    // 替换 identifier 里的 digit、number 和 letter
+    _replaceAll(number, "DIGIT", "(" + digit + ")");
+    _replaceAll(identifier, "NUMBER", number);
+    _replaceAll(identifier, "LETTER", "(" + letter + ")");
+    _replaceAll(identifier, "DIGIT", "(" + digit + ")");
+
+    // 拼接总的正则表达式
+    std::vector<std::pair<std::string, std::string> >& rules = spec.rules;
+    rules.clear();
+    for (auto it = op.begin(); it != op.end(); ++it) {
+        rules.emplace_back(it->second, it->first);
+    }
+    if (identifier.size() > 0) {
+        rules.emplace_back("IDENTIFIER", identifier);
+    }
+    if (number.size() > 0) {
+        rules.emplace_back("NUMBER", number);
+    }
+    if (spec.comment.size() > 0) {
+        rules.emplace_back("COMMENT", spec.comment);
+    }
+    spec.regex = "";
+    for (int it = 0; it < rules.size(); ++it) {
+        spec.regex += rules[it].second;
+        if (it != rules.size() - 1) spec.regex += "|";
+    }
+
+    // map里的key要把转译字符删掉
+    spec.reserved.clear();
+    spec.op.clear();
+    for (auto& it : reserved) {
+        spec.reserved[_removeEscape(it.first)] = it.second;
+    }
+    for (auto& it : op) {
+        spec.op[_removeEscape(it.first)] = it.second;
+    }
+}
+
+// 读取YAML文本并生成分词规则
+bool loadLexSpec(std::string text, LexSpec& spec, std::string& error, LexStats* stats) {
+    YAML::Node doc;
+    {
+        LexStageTimer timer(stats ? &stats->load : nullptr);
+        // 替换空格
+        std::string preload = _replaceAll(text, " | ", "|");
+        // YAML 文件可能在解析时抛出错误
+        try {
+            doc = YAML::Load(preload);
+        }
+        catch (const std::exception& e) {
+            error = std::string("YAML 文件解析错误: ") + e.what();
+            return false;
+        }
+        if (!checkLexSpec(doc, error)) {
+            return false;
+        }
+    }
+    LexStageTimer timer(stats ? &stats->preprocess : nullptr);
+    // 类型不符（如数组元素不是string）时 as<> 会抛出错误
+    try {
+        buildLexSpec(doc, spec);
+    }
+    catch (const std::exception& e) {
+        error = std::string("YAML 文件内容有误: ") + e.what();
+        return false;
+    }
+    return true;
+}
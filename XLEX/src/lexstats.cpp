@@ -0,0 +1,81 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 20:05:12
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /XLEX/src/lexstats.cpp
+ * @Description: 分词器构建各阶段的耗时、计数和内存分配（不依赖 Qt）
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexstats.h"
+#include "memcount.h"
+#include <sstream>
+
+bool lexMemoryCounted() {
+    return memoryCounted();
+}
+
+LexStageTimer::LexStageTimer(LexStage* stage) : stage(stage) {
+    if (!stage) return;
+    if (lexMemoryCounted()) {
+        MemoryCounters counters = memoryCounters();
+        allocated = counters.allocated;
+        allocations = counters.allocations;
+        live = counters.live;
+        // 峰值从阶段开始时重新记录
+        resetMemoryPeak();
+    }
+    begin = std::chrono::steady_clock::now();
+}
+
+LexStageTimer::~LexStageTimer() {
+    if (!stage) return;
+    stage->ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    stage->runs++;
+    if (lexMemoryCounted()) {
+        MemoryCounters counters = memoryCounters();
+        stage->allocated += counters.allocated - allocated;
+        stage->allocations += counters.allocations - allocations;
+        stage->retained += (long long)counters.live - (long long)live;
+        if (counters.peak > live && counters.peak - live > stage->peak) stage->peak = counters.peak - live;
+    }
+}
+
+std::string LexStats::toJson() const {
+    std::stringstream ss;
+    const std::pair<const char*, const LexStage*> stages[] = {
+        { "load", &load },
+        { "preprocess", &preprocess },
+        { "nfa", &nfa },
+        { "dfa", &dfa },
+        { "mdfa", &mdfa },
+        { "table", &table },
+        { "cache", &cache },
+        { "codegen", &codegen },
+    };
+    bool memory = lexMemoryCounted();
+    ss << "{\"stages\":{";
+    bool first = true;
+    for (auto& it : stages) {
+        if (!first) ss << ',';
+        first = false;
+        const LexStage& stage = *it.second;
+        ss << '"' << it.first << "\":{\"ms\":" << stage.ms << ",\"runs\":" << stage.runs;
+        if (memory) {
+            ss << ",\"alloc_bytes\":" << stage.allocated
+                << ",\"allocs\":" << stage.allocations
+                << ",\"retained_bytes\":" << stage.retained
+                << ",\"peak_bytes\":" << stage.peak;
+        }
+        ss << '}';
+    }
+    ss << "},\"counters\":{"
+        << "\"nfa_nodes\":" << nfaNodes
+        << ",\"closures\":" << closures
+        << ",\"dfa_states\":" << dfaStates
+        << ",\"subset_comparisons\":" << subsetComparisons
+        << ",\"partition_splits\":" << partitionSplits
+        << ",\"mdfa_states\":" << mdfaStates
+        << "},\"cached\":" << (cached ? "true" : "false")
+        << ",\"memory\":" << (memory ? "true" : "false") << '}';
+    return ss.str();
+}
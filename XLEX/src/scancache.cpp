@@ -0,0 +1,191 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 16:42:18
+ * @LastEditTime: 2026-10-19 23:59:59
+ * @FilePath: /XLEX/src/scancache.cpp
+ * @Description: 编译后自动机的持久化缓存：按规则哈希存取扁平转移表，读取时直接映射文件
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "scancache.h"
+#include "cachefile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char MAGIC[8] = { 'X', 'L', 'E', 'X', 'S', 'C', 'A', 'N' };
+    const uint32_t ENDIAN_MARK = 0x01020304;
+
+    // 各段下标
+    enum Section { CLASS_OF, TRANSFERS, FLAGS, META, SECTION_COUNT };
+
+    // 文件头
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint64_t specHash;
+        int32_t classCount;
+        int32_t stateCount;
+        uint64_t fileSize;
+        uint64_t offsets[SECTION_COUNT];
+        uint64_t sizes[SECTION_COUNT];
+    };
+
+    // FNV-1a 64
+    void hashBytes(uint64_t& hash, const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    // 带长度前缀，避免拼接产生歧义
+    void hashString(uint64_t& hash, const std::string& str) {
+        uint64_t size = str.size();
+        hashBytes(hash, &size, sizeof(size));
+        hashBytes(hash, str.data(), str.size());
+    }
+
+    void putPairs(std::string& buf, const std::map<std::string, std::string>& pairs) {
+        uint32_t size = pairs.size();
+        buf.append((const char*)&size, sizeof(size));
+        for (auto& it : pairs) {
+            putCacheString(buf, it.first);
+            putCacheString(buf, it.second);
+        }
+    }
+
+    // 读取 putPairs 写入的键值对，越界时返回false
+    bool getPairs(CacheReader& reader, std::map<std::string, std::string>& pairs) {
+        uint32_t size;
+        if (!reader.getSize(size)) return false;
+        pairs.clear();
+        for (uint32_t i = 0; i < size; ++i) {
+            std::string key, value;
+            if (!reader.getString(key) || !reader.getString(value)) return false;
+            pairs[key] = value;
+        }
+        return true;
+    }
+}
+
+uint64_t hashLexSpec(const LexSpec& spec) {
+    uint64_t hash = 14695981039346656037ull;
+    // 自动机只取决于总正则，reserved、op 影响分词归类和生成代码
+    hashString(hash, spec.regex);
+    for (auto* pairs : { &spec.reserved, &spec.op }) {
+        uint64_t size = pairs->size();
+        hashBytes(hash, &size, sizeof(size));
+        for (auto& it : *pairs) {
+            hashString(hash, it.first);
+            hashString(hash, it.second);
+        }
+    }
+    return hash;
+}
+
+std::string scanCachePath(const std::string& dir, const LexSpec& spec) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.xlexc", (unsigned long long)hashLexSpec(spec));
+    return (fs::u8path(dir) / name).u8string();
+}
+
+bool saveScanCache(const std::string& path, const LexSpec& spec, const ScanTable& table, std::string& error) {
+    std::string meta;
+    putCacheString(meta, table.symbols);
+    putCacheString(meta, spec.regex);
+    putPairs(meta, spec.reserved);
+    putPairs(meta, spec.op);
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = SCAN_CACHE_VERSION;
+    header.endian = ENDIAN_MARK;
+    header.specHash = hashLexSpec(spec);
+    header.classCount = table.classCount;
+    header.stateCount = table.stateCount;
+    const void* sections[SECTION_COUNT] = { table.classOf, table.transfers, table.flags, meta.data() };
+    header.sizes[CLASS_OF] = 256 * sizeof(int32_t);
+    header.sizes[TRANSFERS] = (uint64_t)table.stateCount * table.classCount * sizeof(int32_t);
+    header.sizes[FLAGS] = table.stateCount;
+    header.sizes[META] = meta.size();
+    header.fileSize = layoutCacheSections(sizeof(header), header.sizes, header.offsets, SECTION_COUNT);
+    return writeCacheFile(path, &header, sizeof(header), sections, header.offsets, header.sizes, SECTION_COUNT, header.fileSize, error);
+}
+
+bool loadScanCache(const std::string& path, uint64_t hash, LexSpec& spec, ScanTable& table, std::string& error) {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        error = "无法读取缓存文件 " + path;
+        return false;
+    }
+    const char* data = file->data();
+    CacheHeader header;
+    if (file->size() < sizeof(header)) {
+        error = "缓存文件不完整";
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.endian != ENDIAN_MARK) {
+        error = "不是有效的缓存文件";
+        return false;
+    }
+    if (header.version != SCAN_CACHE_VERSION) {
+        error = "缓存文件版本不符";
+        return false;
+    }
+    if (header.specHash != hash) {
+        error = "缓存文件与分词规则不符";
+        return false;
+    }
+    if (header.fileSize != file->size() || header.classCount <= 0 || header.stateCount <= 0
+        || header.sizes[CLASS_OF] != 256 * sizeof(int32_t)
+        || header.sizes[TRANSFERS] != (uint64_t)header.stateCount * header.classCount * sizeof(int32_t)
+        || header.sizes[FLAGS] != (uint64_t)header.stateCount) {
+        error = "缓存文件已损坏";
+        return false;
+    }
+    if (!checkCacheSections(header.offsets, header.sizes, SECTION_COUNT, header.fileSize)) {
+        error = "缓存文件已损坏";
+        return false;
+    }
+
+    const int32_t* classOf = (const int32_t*)(data + header.offsets[CLASS_OF]);
+    const int32_t* transfers = (const int32_t*)(data + header.offsets[TRANSFERS]);
+    for (int c = 0; c < 256; ++c) {
+        if (classOf[c] < 0 || classOf[c] >= header.classCount) {
+            error = "缓存文件已损坏";
+            return false;
+        }
+    }
+    // 转移目标越界会让分词器读到表外，这里整体校验一遍
+    size_t entries = (size_t)header.stateCount * header.classCount;
+    for (size_t i = 0; i < entries; ++i) {
+        if (transfers[i] < -1 || transfers[i] >= header.stateCount) {
+            error = "缓存文件已损坏";
+            return false;
+        }
+    }
+
+    CacheReader reader{ data + header.offsets[META], data + header.offsets[META] + header.sizes[META] };
+    std::string symbols;
+    if (!reader.getString(symbols) || !reader.getString(spec.regex)
+        || !getPairs(reader, spec.reserved) || !getPairs(reader, spec.op)) {
+        error = "缓存文件已损坏";
+        return false;
+    }
+
+    table.classCount = header.classCount;
+    table.stateCount = header.stateCount;
+    table.classOf = classOf;
+    table.transfers = transfers;
+    table.flags = (const uint8_t*)(data + header.offsets[FLAGS]);
+    table.symbols = symbols;
+    table.storage = file;
+    return true;
+}
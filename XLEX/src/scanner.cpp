@@ -0,0 +1,137 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 14:10:26
+ * @LastEditTime: 2026-10-19 23:59:02
+ * @FilePath: /XLEX/src/scanner.cpp
+ * @Description: 基于扁平转移表的进程内分词器，行为与生成的分词程序一致
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "scanner.h"
+
+namespace {
+    bool isBlank(char c) {
+        return c == '\n' || c == ' ' || c == '\t';
+    }
+}
+
+Scanner::Scanner(Lexer& lexer) : table(lexer.getTable()), spec(lexer.getSpec()) {
+    // 与生成代码的 handleToken 一致：关键字优先于运算符
+    for (auto& it : spec.reserved) {
+        lexemes.emplace(it.first, labelOf(it.second));
+    }
+    for (auto& it : spec.op) {
+        lexemes.emplace(it.first, labelOf(it.second));
+    }
+    numberLabel = labelOf("NUMBER");
+    commentLabel = labelOf("COMMENT");
+    identifierLabel = labelOf("IDENTIFIER");
+}
+
+// Label 编号，不存在则新增
+int Scanner::labelOf(const std::string& label) {
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (labels[i] == label) return i;
+    }
+    labels.push_back(label);
+    return labels.size() - 1;
+}
+
+// 分词归类，与生成代码的 handleToken 一致
+int Scanner::classify(std::string_view token) const {
+    auto it = lexemes.find(token);
+    if (it != lexemes.end()) return it->second;
+    if (token[0] >= '0' && token[0] <= '9') return numberLabel;
+    if (token.size() >= 2 && !((token[0] >= 'a' && token[0] <= 'z') || (token[0] >= 'A' && token[0] <= 'Z'))) return commentLabel;
+    return identifierLabel;
+}
+
+Scanner::Cursor Scanner::scan(const std::string& source) const {
+    return Cursor(*this, source);
+}
+
+const ScanTable& Scanner::getTable() const {
+    return table;
+}
+
+const std::vector<std::string>& Scanner::getLabels() const {
+    return labels;
+}
+
+int Scanner::getCommentLabel() const {
+    return commentLabel;
+}
+
+Scanner::Cursor::Cursor(const Scanner& scanner, const std::string& source)
+    : scanner(scanner), data(source.data()), size(source.size()) {}
+
+const std::string& Scanner::Cursor::getError() const {
+    return error;
+}
+
+// 读取下一个分词
+bool Scanner::Cursor::next(LexToken& token) {
+    const ScanTable& table = scanner.table;
+    const int32_t* classOf = table.classOf;
+    const int32_t* transfers = table.transfers;
+    const uint8_t* flags = table.flags;
+    int state = 0;
+    size_t begin = pos;
+    size_t length = 0; // 当前分词长度，分词总是连续的一段
+    // 输出[begin, begin + length)
+    auto emit = [&]() {
+        token.label = scanner.classify(std::string_view(data + begin, length));
+        token.begin = begin;
+        token.end = begin + length;
+        return true;
+    };
+
+    while (error.empty() && pos < size) {
+        char id = data[pos];
+        int next = transfers[(size_t)state * table.classCount + classOf[(unsigned char)id]];
+        if (next >= 0) {
+            if (length == 0) begin = pos;
+            state = next;
+            length++;
+            pos++;
+            continue;
+        }
+        if (flags[state] & SCAN_ANY) {
+            // 只有换行符会走到这里：换行结束当前分词
+            pos++;
+            if (length > 0) return emit();
+            state = 0;
+            continue;
+        }
+        if (flags[state] & SCAN_ACCEPT) {
+            // 拿到一个分词，非空白字符留给下一个分词
+            if (length > 0) {
+                if (isBlank(id)) pos++;
+                return emit();
+            }
+            pos++;
+            state = 0;
+            continue;
+        }
+        if (isBlank(id) && length == 0) {
+            pos++;
+            continue;
+        }
+        // 出错位置
+        size_t line = 1, column = 1;
+        for (size_t i = 0; i < pos; ++i) {
+            if (data[i] == '\n') {
+                line++;
+                column = 1;
+            }
+            else column++;
+        }
+        error = "第" + to_string(line) + "行第" + to_string(column) + "列: 非法输入字符";
+        return false;
+    }
+    // 读取完毕，最后的分词需停在终结状态
+    if (error.empty() && length > 0) {
+        if (flags[state] & SCAN_ACCEPT) return emit();
+        error = "输入在文件末尾不完整";
+    }
+    return false;
+}
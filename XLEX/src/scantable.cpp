@@ -0,0 +1,97 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 16:05:51
+ * @LastEditTime: 2026-10-19 16:05:51
+ * @FilePath: /XLEX/src/scantable.cpp
+ * @Description: 最小化DFA的扁平转移表，可由MDFA生成或从缓存文件映射
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "scantable.h"
+
+namespace {
+    // MDFA节点在字符c上的转移目标：显式转移优先，其次是任意字符转移（换行符除外）
+    int transferOf(MDfaNode* node, char c) {
+        if (c != ANY) {
+            auto it = node->transfer.find(c);
+            if (it != node->transfer.end()) return it->second;
+        }
+        if (c != '\n') {
+            auto it = node->transfer.find(ANY);
+            if (it != node->transfer.end()) return it->second;
+        }
+        return -1;
+    }
+}
+
+// 由MDFA生成转移表
+ScanTable ScanTable::build(MDfa& mdfa, const set<char>& symbols) {
+    // 转移表数据
+    struct Storage {
+        vector<int32_t> classOf;
+        vector<int32_t> transfers;
+        vector<uint8_t> flags;
+    };
+    shared_ptr<Storage> storage = make_shared<Storage>();
+    ScanTable table;
+    vector<MDfaNode*> nodes = mdfa.getNodes();
+    table.stateCount = nodes.size();
+
+    // 代表字符：每个转移字符、换行符，以及一个其他字符（其余字符的行为都一样）
+    vector<char> representatives;
+    vector<int> representativeOf(256, -1);
+    for (char c : symbols) {
+        if (c == ANY || c == '\n') continue;
+        representativeOf[(unsigned char)c] = representatives.size();
+        representatives.push_back(c);
+    }
+    representativeOf['\n'] = representatives.size();
+    representatives.push_back('\n');
+    int other = -1;
+    for (int c = 0; c < 256; ++c) {
+        if (representativeOf[c] != -1) continue;
+        if (other == -1) {
+            other = representatives.size();
+            representatives.push_back((char)c);
+        }
+        representativeOf[c] = other;
+    }
+
+    // 逐个状态细分：所有状态上转移都相同的字符归为一类
+    vector<int> classes(representatives.size(), 0);
+    map<pair<int, int>, int> split;
+    for (MDfaNode* node : nodes) {
+        split.clear();
+        for (size_t i = 0; i < representatives.size(); ++i) {
+            pair<int, int> key(classes[i], transferOf(node, representatives[i]));
+            classes[i] = split.emplace(key, (int)split.size()).first->second;
+        }
+    }
+    vector<char> sample; // 每个字符类的一个字符
+    for (size_t i = 0; i < representatives.size(); ++i) {
+        if (classes[i] >= (int)sample.size()) sample.resize(classes[i] + 1);
+        sample[classes[i]] = representatives[i];
+    }
+    table.classCount = sample.size();
+    storage->classOf.resize(256);
+    for (int c = 0; c < 256; ++c) {
+        storage->classOf[c] = classes[representativeOf[c]];
+    }
+
+    storage->transfers.resize((size_t)table.stateCount * table.classCount);
+    storage->flags.resize(table.stateCount);
+    for (MDfaNode* node : nodes) {
+        int32_t* row = storage->transfers.data() + (size_t)node->state * table.classCount;
+        for (int cls = 0; cls < table.classCount; ++cls) {
+            row[cls] = transferOf(node, sample[cls]);
+        }
+        storage->flags[node->state] = (node->isEnd ? SCAN_ACCEPT : 0) | (node->transfer.count(ANY) ? SCAN_ANY : 0);
+    }
+
+    table.classOf = storage->classOf.data();
+    table.transfers = storage->transfers.data();
+    table.flags = storage->flags.data();
+    table.symbols = string(symbols.begin(), symbols.end());
+    table.storage = storage;
+    return table;
+}
+
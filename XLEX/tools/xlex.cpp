@@ -0,0 +1,149 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 11:41:09
+ * @LastEditTime: 2026-10-19 23:59:53
+ * @FilePath: /XLEX/tools/xlex.cpp
+ * @Description: 命令行版 XLEX：批量读取 YAML 规则并生成分词程序，无需图形界面
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "lexer.h"
+#include "toolutil.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static void usage() {
+    std::cerr <<
+        "Usage: xlex [-o <output.cpp> | -d <output dir>] [-c <cache dir>] [-q] [--json] <spec.yaml>...\n"
+        "  -o <file>   write the generated scanner to <file> (single spec only)\n"
+        "  -d <dir>    write <spec name>.cpp for every spec into <dir>\n"
+        "  -c <dir>    reuse compiled automata cached in <dir>, caching new ones there\n"
+        "  -q          do not print automaton statistics\n"
+        "  --json      print per-stage timings and counters of every spec as JSON to stdout\n"
+        "Without -o/-d, <spec name>.cpp is written next to each spec.\n";
+}
+
+// 处理单个规则文件，成功返回true；json 非空时写入该规则的 JSON 对象
+static bool build(const std::string& specPath, const std::string& outputPath, const std::string& cacheDir, bool quiet, std::string* json) {
+    std::string text;
+    if (!readFile(specPath, text)) {
+        std::cerr << specPath << ": cannot open file\n";
+        return false;
+    }
+    LexSpec spec;
+    LexStats stats;
+    std::string error;
+    if (!loadLexSpec(text, spec, error, &stats)) {
+        std::cerr << specPath << ": " << error << '\n';
+        return false;
+    }
+    // 各规则语法都正确时拼接出的总正则也正确
+    for (auto& rule : spec.rules) {
+        if (!Nfa::check(rule.second, error)) {
+            std::cerr << specPath << ": " << rule.first << ": " << error << '\n';
+            return false;
+        }
+    }
+    Lexer lexer(spec, cacheDir, stats);
+
+    std::ofstream os(outputPath, std::ios::out | std::ios::binary);
+    if (!os.is_open()) {
+        std::cerr << outputPath << ": cannot open output file\n";
+        return false;
+    }
+    size_t bytes = lexer.generate(os);
+    os.close();
+    if (os.fail()) {
+        std::cerr << outputPath << ": write failed\n";
+        return false;
+    }
+    if (!quiet) {
+        std::cerr << specPath << ": ";
+        // 命中缓存时没有构建 NFA/DFA，只报告转移表
+        if (lexer.fromCache()) {
+            std::cerr << "cached ";
+        }
+        else {
+            std::cerr
+                << "nfa=" << lexer.getNfa().getGraph().end->state + 1 << ' '
+                << "dfa=" << lexer.getDfa().getNodes().size() << ' ';
+        }
+        std::cerr
+            << "mdfa=" << lexer.getTable().stateCount << ' '
+            << "-> " << outputPath << " (" << bytes << " bytes)\n";
+    }
+    if (json) {
+        *json = "{\"spec\":" + quote(specPath) + ",\"output\":" + quote(outputPath)
+            + ",\"bytes\":" + std::to_string(bytes) + ",\"stats\":" + lexer.getStats().toJson() + "}";
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    std::string outputDir;
+    std::string cacheDir;
+    bool quiet = false;
+    bool json = false;
+    std::vector<std::string> specs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "-d") && i + 1 < argc) {
+            (arg == "-o" ? output : outputDir) = argv[++i];
+        }
+        else if (arg == "-c" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        }
+        else if (arg == "-q") {
+            quiet = true;
+        }
+        else if (arg == "--json") {
+            json = true;
+        }
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            usage();
+            return 2;
+        }
+        else {
+            specs.push_back(arg);
+        }
+    }
+    if (specs.empty() || (output.size() && (outputDir.size() || specs.size() > 1))) {
+        usage();
+        return 2;
+    }
+
+    int failed = 0;
+    bool first = true;
+    if (json) std::cout << '[';
+    for (const std::string& specPath : specs) {
+        fs::path target;
+        if (output.size()) {
+            target = output;
+        }
+        else {
+            fs::path spec(specPath);
+            target = (outputDir.size() ? fs::path(outputDir) : spec.parent_path()) / spec.stem();
+            target += ".cpp";
+        }
+        std::string result;
+        if (!build(specPath, target.string(), cacheDir, quiet, json ? &result : nullptr)) {
+            failed++;
+            continue;
+        }
+        if (json) {
+            std::cout << (first ? "" : ",") << '\n' << result;
+            first = false;
+        }
+    }
+    if (json) std::cout << "\n]\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 23:59:10
+ * @LastEditTime: 2026-10-19 23:59:10
+ * @FilePath: /common/cachefile.cpp
+ * @Description: 缓存文件的公共读写：只读映射、按 8 字节对齐排列各段、先写临时文件再改名
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "cachefile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    uint64_t align8(uint64_t n) {
+        return (n + 7) & ~(uint64_t)7;
+    }
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (addr) munmap(addr, length);
+#endif
+}
+
+bool MappedFile::open(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream ifs(fs::u8path(path), std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) return false;
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    buffer = ss.str();
+    length = buffer.size();
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    length = st.st_size;
+    addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        addr = nullptr;
+        return false;
+    }
+    return true;
+#endif
+}
+
+const char* MappedFile::data() const {
+#ifdef _WIN32
+    return buffer.data();
+#else
+    return (const char*)addr;
+#endif
+}
+
+uint64_t layoutCacheSections(size_t headerSize, const uint64_t* sizes, uint64_t* offsets, int count) {
+    uint64_t offset = align8(headerSize);
+    for (int i = 0; i < count; ++i) {
+        offsets[i] = offset;
+        offset = align8(offset + sizes[i]);
+    }
+    return offset;
+}
+
+bool checkCacheSections(const uint64_t* offsets, const uint64_t* sizes, int count, uint64_t fileSize) {
+    for (int i = 0; i < count; ++i) {
+        if (offsets[i] % 8 || offsets[i] > fileSize || sizes[i] > fileSize - offsets[i]) return false;
+    }
+    return true;
+}
+
+bool writeCacheFile(const std::string& path, const void* header, size_t headerSize, const void* const* sections,
+    const uint64_t* offsets, const uint64_t* sizes, int count, uint64_t fileSize, std::string& error) {
+    std::error_code ec;
+    fs::path target = fs::u8path(path);
+    if (target.has_parent_path()) fs::create_directories(target.parent_path(), ec);
+    fs::path temp = target;
+    temp += ".tmp";
+    {
+        std::ofstream os(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!os.is_open()) {
+            error = "无法写入缓存文件 " + temp.u8string();
+            return false;
+        }
+        const char padding[8] = {};
+        os.write((const char*)header, headerSize);
+        uint64_t pos = headerSize;
+        for (int i = 0; i < count; ++i) {
+            os.write(padding, offsets[i] - pos);
+            if (sizes[i]) os.write((const char*)sections[i], sizes[i]);
+            pos = offsets[i] + sizes[i];
+        }
+        os.write(padding, fileSize - pos);
+        os.close();
+        if (os.fail()) {
+            fs::remove(temp, ec);
+            error = "写入缓存文件失败 " + temp.u8string();
+            return false;
+        }
+    }
+    // 改名是原子的，并发的读取方不会看到写了一半的文件
+    fs::rename(temp, target, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        error = "无法写入缓存文件 " + path;
+        return false;
+    }
+    return true;
+}
+
+void putCacheString(std::string& buf, const std::string& str) {
+    uint32_t size = str.size();
+    buf.append((const char*)&size, sizeof(size));
+    buf += str;
+}
+
+bool CacheReader::getSize(uint32_t& size) {
+    if (end - p < (ptrdiff_t)sizeof(size)) return false;
+    memcpy(&size, p, sizeof(size));
+    p += sizeof(size);
+    return true;
+}
+
+bool CacheReader::getString(std::string& str) {
+    uint32_t size;
+    if (!getSize(size) || (uint64_t)(end - p) < size) return false;
+    str.assign(p, size);
+    p += size;
+    return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 23:59:10
+ * @LastEditTime: 2026-10-19 23:59:10
+ * @FilePath: /common/cachefile.h
+ * @Description: 缓存文件的公共读写：只读映射、按 8 字节对齐排列各段、先写临时文件再改名
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef CACHEFILE_H
+#define CACHEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * XLEX 的自动机缓存和 LR_SLR 的分析表缓存共用同一种布局：
+ * 文件头（各自定义，含各段偏移和长度）之后依次是各段，每段按 8 字节对齐，可直接映射使用
+ */
+
+// 只读映射的缓存文件，随最后一个引用它的表释放；Windows 下读入内存
+class MappedFile {
+private:
+#ifdef _WIN32
+    std::string buffer;
+#else
+    void* addr = nullptr;
+#endif
+    size_t length = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool open(const std::string& path);
+    const char* data() const;
+    size_t size() const {
+        return length;
+    }
+};
+
+// 各段按 8 字节对齐依次排在文件头之后，写入 offsets 并返回文件长度
+uint64_t layoutCacheSections(size_t headerSize, const uint64_t* sizes, uint64_t* offsets, int count);
+
+// 各段是否 8 字节对齐且都在文件内
+bool checkCacheSections(const uint64_t* offsets, const uint64_t* sizes, int count, uint64_t fileSize);
+
+// 写入文件头和各段（先写临时文件再改名），失败时返回false并写入error
+bool writeCacheFile(const std::string& path, const void* header, size_t headerSize, const void* const* sections,
+    const uint64_t* offsets, const uint64_t* sizes, int count, uint64_t fileSize, std::string& error);
+
+// 追加长度前缀字符串
+void putCacheString(std::string& buf, const std::string& str);
+
+// 按长度前缀读取字符串，越界时返回false
+struct CacheReader {
+    const char* p;
+    const char* end;
+
+    bool getSize(uint32_t& size);
+    bool getString(std::string& str);
+};
+
+#endif // CACHEFILE_H
@@ -0,0 +1,49 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 23:59:40
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /common/memcount.cpp
+ * @Description: 全进程的内存计数，由计数分配器（memhook.cpp）更新，XLEX 和 LR_SLR 的阶段统计读取
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "memcount.h"
+#include <atomic>
+
+namespace {
+    // 常量初始化，静态构造之前的分配也能计数
+    std::atomic<bool> counted(false);
+    std::atomic<size_t> totalAllocated(0);
+    std::atomic<size_t> totalAllocations(0);
+    std::atomic<size_t> liveBytes(0);
+    std::atomic<size_t> peakBytes(0);
+}
+
+void memoryAllocated(size_t size) {
+    counted.store(true, std::memory_order_relaxed);
+    totalAllocated.fetch_add(size, std::memory_order_relaxed);
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+}
+
+void memoryFreed(size_t size) {
+    liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+bool memoryCounted() {
+    return counted.load(std::memory_order_relaxed);
+}
+
+MemoryCounters memoryCounters() {
+    MemoryCounters counters;
+    counters.allocated = totalAllocated.load(std::memory_order_relaxed);
+    counters.allocations = totalAllocations.load(std::memory_order_relaxed);
+    counters.live = liveBytes.load(std::memory_order_relaxed);
+    counters.peak = peakBytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void resetMemoryPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
@@ -0,0 +1,34 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 23:59:40
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /common/memcount.h
+ * @Description: 全进程的内存计数，由计数分配器（memhook.cpp）更新，XLEX 和 LR_SLR 的阶段统计读取
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef MEMCOUNT_H
+#define MEMCOUNT_H
+
+#include <cstddef>
+
+// 某一时刻的计数
+struct MemoryCounters {
+    size_t allocated = 0; // 累计分配的字节数
+    size_t allocations = 0; // 累计分配次数
+    size_t live = 0; // 存活字节数
+    size_t peak = 0; // 上次 resetMemoryPeak 以来存活字节数的峰值
+};
+
+// 由计数分配器的 operator new/delete 调用
+void memoryAllocated(size_t size);
+void memoryFreed(size_t size);
+
+// 是否链接了计数分配器（有过计数）
+bool memoryCounted();
+
+MemoryCounters memoryCounters();
+
+// 峰值从当前的存活字节数重新记录
+void resetMemoryPeak();
+
+#endif // MEMCOUNT_H
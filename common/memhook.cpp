@@ -0,0 +1,85 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 21:24:37
+ * @LastEditTime: 2026-10-19 23:59:40
+ * @FilePath: /common/memhook.cpp
+ * @Description: 计数分配器：替换全局 operator new/delete，把分配和释放的字节数记入 memcount
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ *
+ * 只链接到命令行工具和基准测试（xlex、xlexbench、slrparse、slrbench），不属于 libcommon；
+ * 图形界面不链接：Windows 上 Qt 的 DLL 会用自己的 operator delete 释放程序分配的对象，带头部的内存块会破坏堆
+ */
+#include "memcount.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // 每块内存前保留一段头部记录大小，保持 max_align_t 对齐
+    const size_t HEADER = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+    void* countedAlloc(size_t size) {
+        void* block = std::malloc(size + HEADER);
+        if (!block) return nullptr;
+        *static_cast<size_t*>(block) = size;
+        memoryAllocated(size);
+        return static_cast<char*>(block) + HEADER;
+    }
+
+    void countedFree(void* ptr) {
+        if (!ptr) return;
+        void* block = static_cast<char*>(ptr) - HEADER;
+        memoryFreed(*static_cast<size_t*>(block));
+        std::free(block);
+    }
+
+    void* allocOrThrow(size_t size) {
+        for (;;) {
+            void* ptr = countedAlloc(size ? size : 1);
+            if (ptr) return ptr;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+}
+
+void* operator new(size_t size) {
+    return allocOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+    return allocOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
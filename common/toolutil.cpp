@@ -0,0 +1,48 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 23:59:26
+ * @LastEditTime: 2026-10-19 23:59:26
+ * @FilePath: /common/toolutil.cpp
+ * @Description: 命令行工具和基准测试共用的辅助函数：读取文件、计时、JSON字符串转义
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "toolutil.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool readFile(const std::string& path, std::string& content) {
+    std::ifstream ifs(path, std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) return false;
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    content = ss.str();
+    return true;
+}
+
+double elapsed(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - from).count();
+}
+
+std::string quote(const std::string& str) {
+    std::string ret = "\"";
+    for (unsigned char c : str) {
+        switch (c) {
+        case '"': ret += "\\\""; break;
+        case '\\': ret += "\\\\"; break;
+        case '\n': ret += "\\n"; break;
+        case '\r': ret += "\\r"; break;
+        case '\t': ret += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                ret += buf;
+            }
+            else {
+                ret += c;
+            }
+        }
+    }
+    return ret + "\"";
+}
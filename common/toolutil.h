@@ -0,0 +1,24 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 23:59:26
+ * @LastEditTime: 2026-10-19 23:59:26
+ * @FilePath: /common/toolutil.h
+ * @Description: 命令行工具和基准测试共用的辅助函数：读取文件、计时、JSON字符串转义
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef TOOLUTIL_H
+#define TOOLUTIL_H
+
+#include <chrono>
+#include <string>
+
+// 读取整个文件
+bool readFile(const std::string& path, std::string& content);
+
+// 距离from经过的毫秒数
+double elapsed(std::chrono::steady_clock::time_point from);
+
+// JSON字符串转义，带两侧引号
+std::string quote(const std::string& str);
+
+#endif // TOOLUTIL_H
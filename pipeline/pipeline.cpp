@@ -0,0 +1,64 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 15:02:48
+ * @LastEditTime: 2026-10-19 15:02:48
+ * @FilePath: /pipeline/pipeline.cpp
+ * @Description: XLEX 分词 + LR_SLR 语法分析的进程内流水线，不经过 LEX 文本
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "scanner.h"
+// XLEX 和 LR_SLR 各自定义了不同的 EPSILON，这里都用不到
+#undef EPSILON
+#include "pipeline.h"
+
+namespace {
+    // 分词游标 -> 记号流，跳过注释
+    class ScanTokenStream : public TokenStream {
+    private:
+        Scanner::Cursor cursor;
+        const std::vector<int>& terminalOf;
+        int commentLabel;
+
+    public:
+        ScanTokenStream(const Scanner& scanner, const std::string& source, const std::vector<int>& terminalOf)
+            : cursor(scanner.scan(source)), terminalOf(terminalOf), commentLabel(scanner.getCommentLabel()) {}
+
+        bool next(InputToken& token) override {
+            LexToken lexToken;
+            while (cursor.next(lexToken)) {
+                if (lexToken.label == commentLabel) continue;
+                token.terminal = terminalOf[lexToken.label];
+                token.begin = lexToken.begin;
+                token.end = lexToken.end;
+                return true;
+            }
+            return false;
+        }
+
+        std::string getError() override {
+            return cursor.getError();
+        }
+    };
+}
+
+Pipeline::Pipeline(Scanner& scanner, Grammer& grammer) : scanner(scanner), grammer(grammer) {
+    for (const std::string& label : scanner.getLabels()) {
+        terminalOf.push_back(grammer.terminalId(label));
+    }
+}
+
+// 分词并解析源代码
+ParsedResult Pipeline::parse(const std::string& source) {
+    ScanTokenStream tokens(scanner, source, terminalOf);
+    return grammer.parse(tokens, source);
+}
+
+// 文法中没有的 Label
+std::vector<std::string> Pipeline::getMissingLabels() const {
+    std::vector<std::string> missing;
+    const std::vector<std::string>& labels = scanner.getLabels();
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (terminalOf[i] < 0 && (int)i != scanner.getCommentLabel()) missing.push_back(labels[i]);
+    }
+    return missing;
+}
@@ -0,0 +1,34 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 15:02:48
+ * @LastEditTime: 2026-10-19 15:02:48
+ * @FilePath: /pipeline/pipeline.h
+ * @Description: XLEX 分词 + LR_SLR 语法分析的进程内流水线，不经过 LEX 文本
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "grammer.h"
+#include <string>
+#include <vector>
+
+class Scanner;
+
+// 分词结果直接以终结符号编号和源文本区间交给 Grammer::parse
+class Pipeline {
+private:
+    Scanner& scanner;
+    Grammer& grammer;
+    std::vector<int> terminalOf; // Label 编号 -> 终结符号编号，文法中没有的为-1
+
+public:
+    Pipeline(Scanner& scanner, Grammer& grammer);
+
+    // 分词并解析源代码
+    ParsedResult parse(const std::string& source);
+    // 分词器会输出、但文法中没有的 Label（COMMENT 除外）
+    std::vector<std::string> getMissingLabels() const;
+};
+
+#endif // PIPELINE_H
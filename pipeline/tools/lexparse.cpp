@@ -0,0 +1,106 @@
+/*
+ * @Author: 翁行
+ * @Date: 2026-10-19 15:31:12
+ * @LastEditTime: 2026-10-19 23:59:26
+ * @FilePath: /pipeline/tools/lexparse.cpp
+ * @Description: 命令行版流水线：用 YAML 规则分词后直接按文法解析源代码
+ * Copyright 2024 (c) 翁行, All Rights Reserved.
+ */
+#include "scanner.h"
+#undef EPSILON
+#include "pipeline.h"
+#include "toolutil.h"
+#include <chrono>
+#include <iostream>
+
+static void usage() {
+    std::cerr <<
+        "Usage: lexparse [-t] [-c <cache dir>] <spec.yaml> <grammar.txt> <source>...\n"
+        "  -t         print the syntax tree of every accepted source\n"
+        "  -c <dir>   reuse automata and parse tables cached in <dir>, caching new ones there\n"
+        "Exit status: 0 if every source is accepted, 1 if any is rejected,\n"
+        "2 on usage, spec or grammar errors.\n";
+}
+
+// 以缩进文本输出语法树
+static void printTree(TreeNode* tree, int depth) {
+    if (!tree) return;
+    std::cout << std::string(depth * 2, ' ') << tree->label;
+    if (tree->value.size()) std::cout << " : " << tree->value;
+    std::cout << '\n';
+    for (TreeNode* child : tree->children) printTree(child, depth + 1);
+}
+
+int main(int argc, char* argv[]) {
+    bool withTree = false;
+    std::string cacheDir;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-t") withTree = true;
+        else if (arg == "-c" && i + 1 < argc) cacheDir = argv[++i];
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            usage();
+            return 2;
+        }
+        else paths.push_back(arg);
+    }
+    if (paths.size() < 3) {
+        usage();
+        return 2;
+    }
+
+    std::string text;
+    std::string error;
+    LexSpec spec;
+    if (!readFile(paths[0], text) || !loadLexSpec(text, spec, error)) {
+        std::cerr << paths[0] << ": " << (error.size() ? error : "cannot open file") << '\n';
+        return 2;
+    }
+    if (!readFile(paths[1], text)) {
+        std::cerr << paths[1] << ": cannot open file\n";
+        return 2;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    Lexer lexer(spec, cacheDir);
+    Scanner scanner(lexer);
+    double scannerTime = elapsed(begin);
+    begin = std::chrono::steady_clock::now();
+    Grammer grammer(text, cacheDir);
+    double grammerTime = elapsed(begin);
+    if (grammer.bad()) {
+        std::cerr << paths[1] << ": " << grammer.getError() << '\n';
+        return 2;
+    }
+    Pipeline pipeline(scanner, grammer);
+    for (const std::string& label : pipeline.getMissingLabels()) {
+        std::cerr << "warning: label " << label << " is not a terminal of " << paths[1] << '\n';
+    }
+    std::cout << "scanner " << (lexer.fromCache() ? "loaded" : "built") << " in " << scannerTime << " ms, grammar " << (grammer.fromCache() ? "loaded" : "built") << " in " << grammerTime << " ms\n";
+
+    int rejected = 0;
+    for (size_t i = 2; i < paths.size(); ++i) {
+        ParsedResult result;
+        double parseTime = 0;
+        if (!readFile(paths[i], text)) {
+            result.error = "cannot open file";
+        }
+        else {
+            begin = std::chrono::steady_clock::now();
+            result = pipeline.parse(text);
+            parseTime = elapsed(begin);
+        }
+        bool accept = result.accept && result.error.empty();
+        if (!accept) rejected++;
+        std::cout << paths[i] << ": " << (accept ? "ACCEPT" : "REJECT") << " in " << parseTime << " ms";
+        if (result.error.size()) std::cout << " (" << result.error << ')';
+        std::cout << '\n';
+        if (withTree && accept) printTree(result.root, 1);
+        freeTree(result.root);
+    }
+    return rejected ? 1 : 0;
+}